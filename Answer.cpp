@@ -8,14 +8,28 @@
 //------------------------------------------------------------------------------
 
 #include "Answer.hpp"
+#ifdef LOCAL
+#include "AnswerRegistry.hpp"
+#include "StageContext.hpp"
+#include "Stats.hpp"
+#include "Tunable.hpp"
+#include <time.h>
+#endif
+#ifndef HPC_STATS_ADD
+#define HPC_STATS_ADD(aCounter, aValue)
+#endif
 #include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <ctime>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <random>
 #include <set>
+#include <unordered_set>
 #include <vector>
 #define repeat(i, n) for (int i = 0; (i) < int(n); ++(i))
 #define repeat_from(i, m, n) for (int i = (m); (i) < int(n); ++(i))
@@ -45,16 +59,18 @@ struct TargetManager {
     enum { NONE = -1, DELIVERED = -2 };
     array<int, Parameter::UFOCount> ufo_to_house;
     array<int, Parameter::MaxHouseCount> house_to_ufo;
-    int from_ufo(int ufo_index) {
+    /// UFOが向かっているか配達済みの家の集合。house_to_ufo が NONE でない家です。
+    HouseSet assigned_houses;
+    int from_ufo(int ufo_index) const {
         return ufo_to_house[ufo_index];
     }
-    int from_house(int house_index) {
+    int from_house(int house_index) const {
         return house_to_ufo[house_index];
     }
-    bool is_targetting(int ufo_index) {
+    bool is_targetting(int ufo_index) const {
         return ufo_to_house[ufo_index] != NONE;
     }
-    bool is_delivered(int house_index) {
+    bool is_delivered(int house_index) const {
         return house_to_ufo[house_index] == DELIVERED;
     }
     void link(int ufo_index, int house_index) {
@@ -62,17 +78,20 @@ struct TargetManager {
         unlink_house(house_index);
         ufo_to_house[ufo_index] = house_index;
         house_to_ufo[house_index] = ufo_index;
+        assigned_houses.add(house_index);
     }
     void unlink_ufo(int ufo_index) {
         int & house_index = ufo_to_house[ufo_index];
         if (house_index == NONE) return;
         house_to_ufo[house_index] = NONE;
+        assigned_houses.remove(house_index);
         house_index = NONE;
     }
     void unlink_house(int house_index) {
         int & ufo_index = house_to_ufo[house_index];
         if (ufo_index == NONE or ufo_index == DELIVERED) return;
         ufo_to_house[ufo_index] = NONE;
+        assigned_houses.remove(house_index);
         ufo_index = NONE;
     }
     void deliver_house(int house_index) {
@@ -111,7 +130,111 @@ Answer::~Answer() {
 
 namespace Solver {
 
-minstd_rand gen;
+/// 乱数。ステージの結果が実行の順番やスレッドによらないよう、ステージごとに初期化します。
+thread_local minstd_rand gen;
+
+/// 調整できる定数です。提出する解答は既定値のまま使い、手元では -tune がスレッドごとに書き換えます。
+struct solver_params_t {
+    /// ランダムな再試行に使う、シミュレーションのターン数の予算の倍率。再試行の回数ではありません。
+    /// 街の組合せごとに、合計で「最良の結果のターン数 x この値」ターンまでロールアウトを進めます。
+    /// 分枝限定で早く打ち切った分だけ再試行の回数が増えます。ターン数で決めるので、時間によらず結果は同じです。
+    int restart_turn_budget_per_turn = 200;
+    /// 街に属さない家を決めるときの、街の半径の倍率
+    double countryside_radius_scale = 1.2;
+    /// 街の家を決め直すときの、街の半径の倍率
+    double town_radius_scale = 2;
+    /// 小さいUFOが、大きいUFOからこの距離より近い家を避ける度合いの距離
+    double large_penalty_radius = 100;
+    /// 再試行ごとに、初手の行き先を選び直す小さいUFOの数の範囲
+    int min_modified = 2;
+    int max_modified = 3;
+    /// 空の小さいUFOが、大きいUFOとの合流点の予測位置を目指すか。false なら大きいUFOの今の位置を追います。
+    /// 大きいUFOの経路はよく組み直されて予測が外れるので、今は追う方が結果が良く、既定では使いません。
+    bool refill_aim = false;
+    /// 大きいUFOに同伴する小さいUFOの数。team_split[街の数 - 1][街の番号]
+    array<array<int, 5>, 5> team_split = {{ {{ 4 }}, {{ 2, 2 }}, {{ 1, 1, 4 }}, {{ 1, 1 }}, {{ 1, 1 }} }};
+};
+thread_local solver_params_t params;
+
+/// ステージの間だけ使う作業用メモリです。
+///
+/// 確保はブロックの先頭から切り出すだけで、個々には解放しません。
+/// Answer::finalize でまとめて巻き戻し、ブロックは次のステージで使い回すので、
+/// 2ステージ目以降は malloc を呼びません。スレッドごとに持つので、並列に実行しても取り合いません。
+class scratch_arena_t {
+public:
+    /// 巻き戻す位置です。
+    struct mark_t { size_t block, used; };
+    scratch_arena_t() : block(0), used(0) {}
+    void *allocate(size_t size, size_t align) {
+        while (true) {
+            if (block == blocks.size()) {
+                size_t block_size = max(default_block_size, size + align);
+                blocks.push_back(make_pair(unique_ptr<char []>(new char[block_size]), block_size));
+            }
+            size_t offset = (used + align - 1) & ~(align - 1);
+            if (offset + size <= blocks[block].second) {
+                used = offset + size;
+                return blocks[block].first.get() + offset;
+            }
+            // 入らなければ残りは捨てて次のブロックへ
+            block += 1;
+            used = 0;
+        }
+    }
+    mark_t mark() const { return { block, used }; }
+    void rewind(mark_t const & m) { block = m.block; used = m.used; }
+    void reset() { rewind({ 0, 0 }); }
+private:
+    static const size_t default_block_size = 1 << 20;
+    vector<pair<unique_ptr<char []>, size_t> > blocks;
+    size_t block;
+    size_t used;
+};
+const size_t scratch_arena_t::default_block_size;
+thread_local scratch_arena_t scratch_arena;
+
+/// scratch_arena から確保するアロケータです。既定ではこのスレッドの scratch_arena を使います。
+template <class T>
+struct scratch_allocator {
+    typedef T value_type;
+    scratch_arena_t *arena;
+    scratch_allocator() : arena(&scratch_arena) {}
+    template <class U> scratch_allocator(scratch_allocator<U> const & other) : arena(other.arena) {}
+    T *allocate(size_t n) { return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T *, size_t) {}
+};
+template <class T, class U> bool operator == (scratch_allocator<T> const & a, scratch_allocator<U> const & b) { return a.arena == b.arena; }
+template <class T, class U> bool operator != (scratch_allocator<T> const & a, scratch_allocator<U> const & b) { return a.arena != b.arena; }
+/// ステージの間だけ使う vector です。Answer::finalize より後まで持ってはいけません。
+template <class T> using scratch_vector = vector<T, scratch_allocator<T> >;
+
+/// scratch_arena をスコープの終わりで巻き戻します。スコープの中で確保したものを外へ持ち出してはいけません。
+struct scratch_scope_t {
+    scratch_arena_t::mark_t mark;
+    scratch_scope_t() : mark(scratch_arena.mark()) {}
+    ~scratch_scope_t() { scratch_arena.rewind(mark); }
+};
+
+/// 解答の中で掛かった時間を測るタイマーです。
+///
+/// 手元の -t では複数のステージを並列に実行するので、他のスレッドの時間を数えないよう、スレッドごとのCPU時間で測ります。
+/// 提出先は1スレッドなので、hpc::Timer と同じくプロセスのCPU時間で測ります。
+struct thread_timer_t {
+#ifdef LOCAL
+    timespec begin;
+    void start() { clock_gettime(CLOCK_THREAD_CPUTIME_ID, &begin); }
+    double elapsed_sec() const {
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return double(now.tv_sec - begin.tv_sec) + double(now.tv_nsec - begin.tv_nsec) * 1e-9;
+    }
+#else
+    clock_t begin;
+    void start() { begin = clock(); }
+    double elapsed_sec() const { return double(clock() - begin) / CLOCKS_PER_SEC; }
+#endif
+};
 
 /// 座標がstage上にあるかを判定します。
 bool is_on_stage(int y, int x) {
@@ -136,29 +259,23 @@ const int FieldMargin = 20;
 /// 検出された街を表現する構造体
 struct town_t {
     Vector2 center;
-    vector<int> house_indices;
+    HouseSet houses;
 };
-bool operator < (town_t const & a, town_t const & b) {
-    if (a.center == b.center) {
-        return a.house_indices < b.house_indices;
-    }
-    return make_pair(a.center.y, a.center.x) < make_pair(b.center.y, b.center.x);
-}
 
-vector<town_t> reconstruct_towns_from_centers(vector<Vector2> const & town_centers, int radius, Houses const & houses) {
-    vector<town_t> towns;
+scratch_vector<town_t> reconstruct_towns_from_centers(scratch_vector<Vector2> const & town_centers, int radius, Houses const & houses) {
+    scratch_vector<town_t> towns;
     for (auto town_center : town_centers) {
         town_t town = {};
         town.center = town_center;
         repeat (house_index, houses.count()) {
             auto const & house = houses[house_index];
             if (house.pos().dist(town.center) <= radius) {
-                town.house_indices.push_back(house_index);
+                town.houses.add(house_index);
             }
         }
 #ifdef DEBUG
-fprintf(stderr, "town (%d, %d) : size %d : ", int(town.center.y), int(town.center.x), int(town.house_indices.size()));
-for (int house_index : town.house_indices) fprintf(stderr, "%d ", house_index);
+fprintf(stderr, "town (%d, %d) : size %d : ", int(town.center.y), int(town.center.x), town.houses.count());
+for (int house_index : town.houses) fprintf(stderr, "%d ", house_index);
 fprintf(stderr, "\n");
 #endif
         towns.push_back(town);
@@ -167,12 +284,11 @@ fprintf(stderr, "\n");
 }
 
 /// 街を検出し列挙します。
-vector<town_t> detect_towns(Houses const & houses) {
+scratch_vector<town_t> detect_towns(Houses const & houses) {
 
     // 各位置から半径TownRadiusで見える家の数を数える。imos法でO(Nr + HW)
     typedef array<array<int8_t, Parameter::StageWidth + 1>, Parameter::StageHeight> cnt_array_t;
-    auto cnt_ptr = unique_ptr<cnt_array_t>(new cnt_array_t {});
-    auto & cnt = *cnt_ptr;
+    auto & cnt = *new (scratch_arena.allocate(sizeof(cnt_array_t), alignof(cnt_array_t))) cnt_array_t {};
     repeat (house_index, houses.count()) {
         auto const & house = houses[house_index];
         repeat_from (dy, - StageParameter::TownRadius, StageParameter::TownRadius + 1) {
@@ -202,45 +318,48 @@ fprintf(stderr, "\n");
 #endif
 
     // 適当な位置からDFSして中心を判断
-    int dfs_max_cnt = -1;
-    Vector2 dfs_pos;
-    function<void (int, int)> dfs = [&](int y, int x) {
-        if (dfs_max_cnt < cnt[y][x]) {  // TODO: これだと真の中心にはならない
-            dfs_max_cnt = cnt[y][x];
-            dfs_pos = Vector2(x, y);
-        }
-        cnt[y][x] = -1;  // 使用済みflagを同居 汚ないが時空間効率のため
-        repeat_from (ny, y - 1, y + 2) {
-            repeat_from (nx, x - 1, x + 2) {
-                if (is_on_stage(ny, nx) and cnt[ny][nx] >= dfs_max_cnt - 1) {
-                    dfs(ny, nx);
+    // std::function だと確保が起きるので、再帰は関数オブジェクトで書く
+    struct dfs_t {
+        cnt_array_t & cnt;
+        int max_cnt;
+        Vector2 pos;
+        void operator () (int y, int x) {
+            if (max_cnt < cnt[y][x]) {  // TODO: これだと真の中心にはならない
+                max_cnt = cnt[y][x];
+                pos = Vector2(x, y);
+            }
+            cnt[y][x] = -1;  // 使用済みflagを同居 汚ないが時空間効率のため
+            repeat_from (ny, y - 1, y + 2) {
+                repeat_from (nx, x - 1, x + 2) {
+                    if (is_on_stage(ny, nx) and cnt[ny][nx] >= max_cnt - 1) {
+                        (*this)(ny, nx);
+                    }
                 }
             }
         }
     };
-    vector<Vector2> town_centers;
+    dfs_t dfs = { cnt, -1, Vector2() };
+    scratch_vector<Vector2> town_centers;
     repeat (y, Parameter::StageHeight) {
         repeat (x, Parameter::StageWidth) {
             if (cnt[y][x] >= StageParameter::TownHouseCount) {
-                dfs_max_cnt = -1;
+                dfs.max_cnt = -1;
                 dfs(y, x);
-                town_centers.push_back(dfs_pos);
+                town_centers.push_back(dfs.pos);
             }
         }
     }
 
     // 街を復元
-    vector<town_t> towns = reconstruct_towns_from_centers(town_centers, StageParameter::TownRadius + 3, houses); // 3 は余裕
+    scratch_vector<town_t> towns = reconstruct_towns_from_centers(town_centers, StageParameter::TownRadius + 3, houses); // 3 は余裕
 
     // 衝突してたら併合
     repeat (town_index, towns.size()) {
         auto const & town = towns[town_index];
         repeat (other_town_index, towns.size()) if (town_index != other_town_index) {
             auto const & other_town = towns[other_town_index];
-            if (town.house_indices.size() <= other_town.house_indices.size()) {
-                vector<int> intersection;
-                set_intersection(whole(town.house_indices), whole(other_town.house_indices), back_inserter(intersection));
-                if (intersection.size() >= 10) {
+            if (town.houses.count() <= other_town.houses.count()) {
+                if ((town.houses & other_town.houses).count() >= 10) {
                     towns.erase(towns.begin() + town_index);
                     -- town_index;
                     break;
@@ -252,8 +371,8 @@ fprintf(stderr, "\n");
 fprintf(stderr, "merged:\n");
 repeat (town_index, towns.size()) {
 auto const & town = towns[town_index];
-fprintf(stderr, "town (%d, %d) : size %d : ", int(town.center.y), int(town.center.x), int(town.house_indices.size()));
-for (int house_index : town.house_indices) fprintf(stderr, "%d ", house_index);
+fprintf(stderr, "town (%d, %d) : size %d : ", int(town.center.y), int(town.center.x), town.houses.count());
+for (int house_index : town.houses) fprintf(stderr, "%d ", house_index);
 fprintf(stderr, "\n");
 }
 #endif
@@ -265,8 +384,8 @@ fprintf(stderr, "\n");
     return towns;
 }
 
-vector<Vector2> get_town_centers(vector<town_t> const & towns) {
-    vector<Vector2> poss;
+scratch_vector<Vector2> get_town_centers(scratch_vector<town_t> const & towns) {
+    scratch_vector<Vector2> poss;
     for (auto const & town : towns) {
         poss.push_back(town.center);
     }
@@ -280,20 +399,444 @@ int turns_to_move(Vector2 const & from, Vector2 const & to, int max_speed) {
     return ceil(from.dist(to) / max_speed);
 }
 
-/// 街に所属しない家の一覧を取得
-vector<int> get_countryside_house_indices(int house_count, vector<town_t> const & towns) {
-    vector<int> xs(house_count);
-    iota(whole(xs), 0);
+/// 街に所属しない家の集合を取得
+HouseSet get_countryside_houses(int house_count, scratch_vector<town_t> const & towns) {
+    HouseSet xs = HouseSet::Range(house_count);
     for (auto const & town : towns) {
-        for (int house_index : town.house_indices) {
-            xs[house_index] = -1;
-        }
+        xs -= town.houses;
     }
-    xs.erase(remove(whole(xs), -1), xs.end());
     return xs;
 }
 
-void move_items_with_towns(Stage const & stage, Actions & actions, TargetManager & target, vector<town_t> const & towns, vector<int> const & countryside_house_indices, vector<int> & initial_house) {
+/// UFOの担当範囲を選択します。大きいUFOへの同伴か否か
+///
+/// @return 担当する街の番号。街に属さない家を担当するなら -1
+int get_ufo_area(int ufo_index, int town_count) {
+    if (ufo_index < Parameter::LargeUFOCount) {
+        return ufo_index < town_count ? ufo_index : -1;
+    }
+    if (town_count < 1 or town_count > int(params.team_split.size())) {
+        return -1;
+    }
+    // 小さいUFOを番号の順に、街ごとの人数ずつ割り振る
+    int i = ufo_index - Parameter::LargeUFOCount;
+    auto const & split = params.team_split[town_count - 1];
+    repeat (town_index, town_count) {
+        if (i < split[town_index]) return town_index;
+        i -= split[town_index];
+    }
+    return -1;
+}
+
+/// 担当範囲ごとの家の集合です。 area_mask[area + 1]
+typedef scratch_vector<HouseSet> area_mask_t;
+area_mask_t make_area_mask(scratch_vector<town_t> const & towns, HouseSet const & countryside_houses) {
+    area_mask_t mask(towns.size() + 1);
+    mask[0] = countryside_houses;
+    repeat (town_index, towns.size()) {
+        mask[town_index + 1] = towns[town_index].houses;
+    }
+    return mask;
+}
+
+/// 初手の小さいUFOの行き先です。UFOごとに、担当範囲の空いている家の何番目か (未定なら -1) を持ちます。
+typedef array<int, Parameter::UFOCount> initial_house_t;
+
+/// UFOと家の最小費用割当をハンガリアン法(最短増加路)で解きます。
+///
+/// 行がUFO、列が家と待機用のダミー列です。
+/// 割当と双対変数はターンをまたいで保持し(warm start)、状態の変わったUFOの行だけを外して増加路で張り直します。
+/// 状態の変わっていないUFOのコストは最後に張り直した時点のものを使うので、その後の移動量の分だけずれます。
+struct assignment_engine_t {
+    enum { ROW = Parameter::UFOCount, COL = Parameter::MaxHouseCount + Parameter::UFOCount };
+    int house_count;
+    int col_count;
+    array<array<double, COL + 1>, ROW + 1> cost;  // 1-indexed。0列目は増加路の番兵
+    array<double, ROW + 1> u;
+    array<double, COL + 1> v;
+    array<int, COL + 1> col_to_row;  // 0 なら空き
+    array<int, ROW + 1> row_to_col;  // 0 なら空き
+    array<bool, ROW + 1> active;
+    array<bool, ROW + 1> pinned;
+    HouseSet forbidden;  // 割当の対象から外した家。待機用の列は外さない
+    array<int, COL> live;  // 禁止されていない列の一覧。増加路の探索はこれだけを見る
+    array<int, COL + 1> live_pos;
+    int live_count;
+    array<int, ROW + 1> refreshed_turn;
+    array<float, Parameter::MaxHouseCount> house_x;
+    array<float, Parameter::MaxHouseCount> house_y;
+
+    static double idle_cost() { return 1e5; }
+    static double forbidden_cost() { return 1e9; }
+
+    void reset(Houses const & houses) {
+        house_count = houses.count();
+        repeat (house_index, house_count) {
+            house_x[house_index] = houses[house_index].pos().x;
+            house_y[house_index] = houses[house_index].pos().y;
+        }
+        col_count = house_count + ROW;
+        fill(whole(u), 0);
+        fill(whole(v), 0);
+        fill(whole(col_to_row), 0);
+        fill(whole(row_to_col), 0);
+        fill(whole(active), false);
+        fill(whole(pinned), false);
+        forbidden.clear();
+        fill(whole(refreshed_turn), -1);
+        live_count = col_count;
+        repeat (k, col_count) {
+            live[k] = k + 1;
+            live_pos[k + 1] = k;
+        }
+    }
+    bool is_active(int ufo_index) const { return active[ufo_index + 1]; }
+    bool is_pinned(int ufo_index) const { return pinned[ufo_index + 1]; }
+    bool is_forbidden(int house_index) const { return forbidden.contains(house_index); }
+    HouseSet const & forbidden_houses() const { return forbidden; }
+    /// 割り当てられた家。待機中や非活性なら -1
+    int house_of(int ufo_index) const {
+        int col = row_to_col[ufo_index + 1];
+        return 1 <= col and col <= house_count ? col - 1 : -1;
+    }
+
+    /// 家を割当の対象から外します。配達済みになったときや、他で固定されたときに呼びます。
+    void forbid(int house_index) {
+        if (forbidden.contains(house_index)) return;
+        forbidden.add(house_index);
+        int col = house_index + 1;
+        repeat_from (row, 1, ROW + 1) cost[row][col] = forbidden_cost();
+        int k = live_pos[col];
+        live[k] = live[-- live_count];
+        live_pos[live[k]] = k;
+        if (col_to_row[col]) unmatch(col_to_row[col]);
+    }
+    /// UFOを割当の対象から外します。
+    void deactivate(int ufo_index) {
+        int row = ufo_index + 1;
+        if (row_to_col[row]) unmatch(row);
+        active[row] = false;
+        pinned[row] = false;
+    }
+    /// UFOを家に固定し、割当の対象から外します。
+    void pin(int ufo_index, int house_index) {
+        deactivate(ufo_index);
+        forbid(house_index);
+        pinned[ufo_index + 1] = true;
+    }
+    /// UFOの行のコストを張り直します。
+    ///
+    /// 家へのコストは 到着までのターン数 + penalty[house_index] です。
+    /// 現在の割当が新しいコストでも双対条件を満たす(タイトである)なら、割当はそのまま保持します。
+    /// まっすぐ目標へ向かっているUFOは、目標へのコストが他のどの家へのコストよりも大きく減るので、通常は保持されます。
+    void update(int ufo_index, int turn, Vector2 const & pos, double speed, array<double, Parameter::MaxHouseCount> const & penalty) {
+        int row = ufo_index + 1;
+        refreshed_turn[row] = turn;
+        active[row] = true;
+        pinned[row] = false;
+        auto & c = cost[row];
+        double inv_speed = 1 / speed;
+        double min_reduced = idle_cost() - v[house_count + 1];
+        repeat (k, live_count) {
+            int col = live[k];
+            if (col <= house_count) {
+                int house_index = col - 1;
+                float dx = house_x[house_index] - pos.x;
+                float dy = house_y[house_index] - pos.y;
+                c[col] = sqrt(dx * dx + dy * dy) * inv_speed + penalty[house_index];
+            } else {
+                c[col] = idle_cost();
+            }
+            min_reduced = min(min_reduced, c[col] - v[col]);
+        }
+        u[row] = min_reduced;
+        int col = row_to_col[row];
+        if (col and c[col] - v[col] > u[row] + 1e-9) {
+            unmatch(row);
+        }
+    }
+    /// 行のコストを最後に張り直したターン。
+    int refreshed_at(int ufo_index) const { return refreshed_turn[ufo_index + 1]; }
+    /// 割当のない活性な行があるかを返します。
+    bool has_unmatched() const {
+        repeat_from (row, 1, ROW + 1) {
+            if (active[row] and not row_to_col[row]) return true;
+        }
+        return false;
+    }
+    /// 割当のない活性な行をすべて増加路で埋めます。
+    void solve() {
+        repeat_from (row, 1, ROW + 1) {
+            if (active[row] and not row_to_col[row]) augment(row);
+        }
+    }
+
+private:
+    /// 行の割当を外します。
+    ///
+    /// 割り当てられていない列の双対変数は 0 でなければ、最小費用の割当になりません。(増加路で負になった列は必ず埋まっています)
+    /// 空いた列の v を 0 に戻し、それで双対条件を破った行は割当を外して、その行の列も同じように戻します。
+    void unmatch(int row) {
+        int col = row_to_col[row];
+        row_to_col[row] = 0;
+        col_to_row[col] = 0;
+        if (v[col] == 0) return;
+        v[col] = 0;
+        repeat_from (i, 1, ROW + 1) {
+            if (row_to_col[i] and cost[i][col] - u[i] < -1e-9) unmatch(i);
+        }
+    }
+    void augment(int row) {
+        array<double, COL + 1> minv;
+        array<bool, COL + 1> used;
+        array<int, COL + 1> way;
+        array<int, ROW + 1> used_cols;  // 木に入った列。一度に増える行は高々 ROW 個
+        int used_count = 0;
+        repeat (k, live_count) {
+            minv[live[k]] = 1e18;
+            used[live[k]] = false;
+        }
+        col_to_row[0] = row;
+        int j0 = 0;
+        do {
+            used[j0] = true;
+            used_cols[used_count ++] = j0;
+            int i0 = col_to_row[j0];
+            auto const & c = cost[i0];
+            double delta = 1e18;
+            int j1 = 0;
+            repeat (k, live_count) {
+                int j = live[k];
+                if (used[j]) continue;
+                double cur = c[j] - u[i0] - v[j];
+                if (cur < minv[j]) {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            repeat (k, used_count) {
+                int j = used_cols[k];
+                u[col_to_row[j]] += delta;
+                v[j] -= delta;
+            }
+            repeat (k, live_count) {
+                int j = live[k];
+                if (not used[j]) minv[j] -= delta;
+            }
+            j0 = j1;
+        } while (col_to_row[j0] != 0);
+        do {
+            int j1 = way[j0];
+            col_to_row[j0] = col_to_row[j1];
+            row_to_col[col_to_row[j0]] = j0;
+            j0 = j1;
+        } while (j0);
+        col_to_row[0] = 0;
+    }
+};
+
+#ifdef LOCAL
+// 差分で更新した割当が、同じコストで一から解いた割当と同じ費用になることを確かめます。
+// 行の張り直し、家の禁止、UFOの非活性化を乱択した順で混ぜます。
+unittest {
+    mt19937 engine;
+    uniform_real_distribution<float> coord(0, Parameter::StageWidth);
+    uniform_real_distribution<double> noise(0, 30);
+    struct row_args_t { Vector2 pos; double speed; array<double, Parameter::MaxHouseCount> penalty; };
+    unique_ptr<assignment_engine_t> warm(new assignment_engine_t());
+    unique_ptr<assignment_engine_t> cold(new assignment_engine_t());
+    unique_ptr<array<row_args_t, Parameter::UFOCount> > args(new array<row_args_t, Parameter::UFOCount>());
+    repeat (trial, 100) {
+        Houses houses;
+        int house_count = uniform_int_distribution<int>(Parameter::UFOCount, Parameter::MaxHouseCount)(engine);
+        repeat (house_index, house_count) houses.add(House(Vector2(coord(engine), coord(engine))));
+        warm->reset(houses);
+        repeat (step, 200) {
+            int ufo_index = uniform_int_distribution<int>(0, Parameter::UFOCount - 1)(engine);
+            int kind = uniform_int_distribution<int>(0, 9)(engine);
+            if (kind < 7) {
+                auto & it = (*args)[ufo_index];
+                it.pos = Vector2(coord(engine), coord(engine));
+                it.speed = ufo_index < Parameter::LargeUFOCount ? Parameter::LargeUFOMaxSpeed : Parameter::SmallUFOMaxSpeed;
+                repeat (house_index, house_count) it.penalty[house_index] = noise(engine);
+                warm->update(ufo_index, step, it.pos, it.speed, it.penalty);
+            } else if (kind < 9) {
+                warm->forbid(uniform_int_distribution<int>(0, house_count - 1)(engine));
+            } else {
+                warm->deactivate(ufo_index);
+            }
+            warm->solve();
+            cold->reset(houses);
+            for (int house_index : warm->forbidden_houses()) cold->forbid(house_index);
+            repeat (i, Parameter::UFOCount) if (warm->is_active(i)) {
+                auto const & it = (*args)[i];
+                cold->update(i, step, it.pos, it.speed, it.penalty);
+            }
+            cold->solve();
+            double warm_cost = 0, cold_cost = 0;
+            repeat_from (row, 1, Parameter::UFOCount + 1) if (warm->active[row]) {
+                assert (warm->row_to_col[row] and cold->row_to_col[row]);
+                warm_cost += warm->cost[row][warm->row_to_col[row]];
+                cold_cost += cold->cost[row][cold->row_to_col[row]];
+            }
+            assert (abs(warm_cost - cold_cost) < 1e-6);
+        }
+    }
+}
+#endif
+
+/// 家どうしの距離の表です。家は動かないので、ステージごとに一度だけ作ります。
+struct travel_matrix_t {
+    int house_count;
+    array<Vector2, Parameter::MaxHouseCount> pos;
+    array<array<float, Parameter::MaxHouseCount>, Parameter::MaxHouseCount> dist;
+
+    void reset(Houses const & houses) {
+        house_count = houses.count();
+        repeat (i, house_count) pos[i] = houses[i].pos();
+        repeat (i, house_count) {
+            dist[i][i] = 0;
+            repeat (j, i) dist[i][j] = dist[j][i] = pos[i].dist(pos[j]);
+        }
+    }
+};
+
+/// UFOごとの配達順序を管理します。
+///
+/// 経路は補給から次の補給までに配る家の列で、長さは持っている箱の数を超えません。
+/// 先頭の家がそのUFOの目標になります。
+/// 経路の費用は 現在地 -> 家 -> ... -> 家 -> 補給場所 の距離の和で、最後の区間だけ重み goal_weight をかけます。
+struct route_planner_t {
+    array<array<int, Parameter::LargeUFOCapacity>, Parameter::UFOCount> route;
+    array<int, Parameter::UFOCount> length;
+
+    void reset() { fill(whole(length), 0); }
+    int size(int ufo_index) const { return length[ufo_index]; }
+    int front(int ufo_index) const { return route[ufo_index][0]; }
+    int at(int ufo_index, int i) const { return route[ufo_index][i]; }
+    int back(int ufo_index) const { return route[ufo_index][length[ufo_index] - 1]; }
+    void pop_front(int ufo_index) {
+        auto & r = route[ufo_index];
+        copy(r.begin() + 1, r.begin() + length[ufo_index], r.begin());
+        length[ufo_index] -= 1;
+    }
+    void clear(int ufo_index) { length[ufo_index] = 0; }
+    bool contains(int ufo_index, int house_index) const {
+        auto const & r = route[ufo_index];
+        return find(r.begin(), r.begin() + length[ufo_index], house_index) != r.begin() + length[ufo_index];
+    }
+    void push_back(int ufo_index, int house_index) { route[ufo_index][length[ufo_index] ++] = house_index; }
+
+    /// 家を最も安い位置へ挿入したときの費用の増分を返します。位置は position に入ります。
+    double insertion_cost(int ufo_index, travel_matrix_t const & travel, Vector2 const & start, Vector2 const & goal, double goal_weight, int house_index, int & position) const {
+        auto const & r = route[ufo_index];
+        int k = length[ufo_index];
+        Vector2 const & p = travel.pos[house_index];
+        double start_dist = p.dist(start);
+        double goal_dist = goal_weight * p.dist(goal);
+        double best = INFINITY;
+        repeat (i, k + 1) {
+            double delta =
+                i == 0 and i == k ? start_dist + goal_dist - goal_weight * start.dist(goal) :
+                i == 0 ? start_dist + travel.dist[house_index][r[0]] - travel.pos[r[0]].dist(start) :
+                i == k ? travel.dist[r[k - 1]][house_index] + goal_dist - goal_weight * travel.pos[r[k - 1]].dist(goal) :
+                travel.dist[r[i - 1]][house_index] + travel.dist[house_index][r[i]] - travel.dist[r[i - 1]][r[i]];
+            if (delta < best) {
+                best = delta;
+                position = i;
+            }
+        }
+        return best;
+    }
+    void insert(int ufo_index, int position, int house_index) {
+        auto & r = route[ufo_index];
+        copy_backward(r.begin() + position, r.begin() + length[ufo_index], r.begin() + length[ufo_index] + 1);
+        r[position] = house_index;
+        length[ufo_index] += 1;
+    }
+
+    /// 2-opt と Or-opt で、改善がなくなるまで配達順序を入れ替えます。
+    void improve(int ufo_index, travel_matrix_t const & travel, Vector2 const & start, Vector2 const & goal, double goal_weight) {
+        auto & r = route[ufo_index];
+        int k = length[ufo_index];
+        if (k <= 1) return;
+        const int START = Parameter::MaxHouseCount, GOAL = Parameter::MaxHouseCount + 1;
+        array<float, Parameter::MaxHouseCount + 2> start_dist, goal_dist;
+        repeat (i, k) {
+            start_dist[r[i]] = travel.pos[r[i]].dist(start);
+            goal_dist[r[i]] = goal_weight * travel.pos[r[i]].dist(goal);
+        }
+        auto edge = [&](int a, int b) -> double {
+            return a == START ? start_dist[b] : b == GOAL ? goal_dist[a] : travel.dist[a][b];
+        };
+        auto node = [&](int i) { return i < 0 ? START : i >= k ? GOAL : r[i]; };
+        const double eps = 1e-6;
+        for (bool improved = true; improved; ) {
+            improved = false;
+            // 2-opt: 区間 [i, j] を反転
+            repeat (i, k) repeat_from (j, i + 1, k) {
+                double delta =
+                    edge(node(i - 1), r[j]) + edge(r[i], node(j + 1))
+                    - edge(node(i - 1), r[i]) - edge(r[j], node(j + 1));
+                if (delta < - eps) {
+                    reverse(r.begin() + i, r.begin() + j + 1);
+                    improved = true;
+                }
+            }
+            // Or-opt: 長さ3までの区間を、向きも含めて別の位置へ移動
+            repeat_from (len, 1, min(3, k - 1) + 1) repeat (i, k - len + 1) {
+                int first = r[i], last = r[i + len - 1];
+                double removed = edge(node(i - 1), first) + edge(last, node(i + len)) - edge(node(i - 1), node(i + len));
+                auto rest = [&](int g) { return g < 0 ? START : g >= k - len ? GOAL : g < i ? r[g] : r[g + len]; };
+                int best_gap = -1;
+                bool best_reversed = false;
+                double best_delta = - eps;
+                repeat (g, k - len + 1) if (g != i) {
+                    int a = rest(g - 1), b = rest(g);
+                    double base = edge(a, b);
+                    double forward = edge(a, first) + edge(last, b) - base - removed;
+                    double backward = edge(a, last) + edge(first, b) - base - removed;
+                    if (forward < best_delta) {
+                        best_delta = forward;
+                        best_gap = g;
+                        best_reversed = false;
+                    }
+                    if (backward < best_delta) {
+                        best_delta = backward;
+                        best_gap = g;
+                        best_reversed = true;
+                    }
+                }
+                if (best_gap != -1) {
+                    array<int, 3> segment;
+                    copy(r.begin() + i, r.begin() + i + len, segment.begin());
+                    if (best_reversed) reverse(segment.begin(), segment.begin() + len);
+                    // 区間を抜いて詰め、挿入位置を空けて入れる
+                    copy(r.begin() + i + len, r.begin() + k, r.begin() + i);
+                    copy_backward(r.begin() + best_gap, r.begin() + k - len, r.begin() + k);
+                    copy(segment.begin(), segment.begin() + len, r.begin() + best_gap);
+                    improved = true;
+                }
+            }
+        }
+    }
+};
+
+/// 担当範囲外の家へ向かうときの罰則(ターン)。街をまたぐ無駄な移動を抑えます。
+const double area_penalty = 20;
+/// 最後の1個を配達した後、最寄りの補給場所へ戻る時間にかける重み。
+const double refill_weight = 0.1;
+/// 状態の変わっていないUFOの行を、張り直さずに使い続けるターン数。
+const int stale_turn_limit = 4;
+/// 経路に並べる家の数の上限。先を読みすぎると乱択の多様性が落ちて悪くなる。
+const int large_route_horizon = 3;
+const int small_route_horizon = 2;
+
+void move_items_with_towns(Stage const & stage, Actions & actions, TargetManager & target, assignment_engine_t & engine, route_planner_t & planner, travel_matrix_t const & travel, scratch_vector<town_t> const & towns, area_mask_t const & area_mask, initial_house_t & initial_house) {
     int house_count = stage.houses().count();
     array<int, Parameter::UFOCount> item_count;
 
@@ -321,158 +864,1202 @@ void move_items_with_towns(Stage const & stage, Actions & actions, TargetManager
             }
         }
 
-        // アイテムないならロックを手放す
-        if (item_count[ufo_index] == 0) {
-            if (target.is_targetting(ufo_index)) {
-                target.unlink_ufo(ufo_index);
+        // 目標の家に着いたら配達。経路の次の家にも触れていれば続けて配る
+        while (item_count[ufo_index] and target.is_targetting(ufo_index)) {
+            int house_index = target.from_ufo(ufo_index);
+            auto const & house = stage.houses()[house_index];
+            if (not Util::IsIntersect(ufo, house)) break;
+            item_count[ufo_index] -= 1;
+            actions.add(Action::Deliver(ufo_index, house_index));
+            target.deliver_house(house_index);
+            engine.forbid(house_index);
+            // 経路の次の家がまだ空いていれば、そのまま次の目標にする
+            if (planner.size(ufo_index) and planner.front(ufo_index) == house_index) {
+                planner.pop_front(ufo_index);
+                if (planner.size(ufo_index) and target.from_house(planner.front(ufo_index)) == TargetManager::NONE) {
+                    target.link(ufo_index, planner.front(ufo_index));
+                }
+            }
+        }
+    }
+
+    // 受け渡しが起きたターンだけ行を張り直す。割当がタイトなままなら増加路は張り直さない
+    // 目標へまっすぐ向かうだけのUFOは割当がタイトなままなので、何も起きないターンは張り直す必要がない
+    // 罰則は担当範囲とUFOの種類だけで決まるので、このターンの中で使い回す
+    array<double, Parameter::MaxHouseCount> large_penalty;
+    bool large_penalty_ready = false;
+    array<array<double, Parameter::MaxHouseCount>, 2 * (Parameter::UFOCount + 1)> penalty_cache;  // 担当範囲の番号はUFOの数未満
+    array<bool, 2 * (Parameter::UFOCount + 1)> penalty_cache_ready = {};
+    array<double, Parameter::MaxHouseCount> refill_penalty;
+    // pos から最寄りの補給場所。小さいUFOは箱の多い大きいUFOからも補給できる
+    auto refill_point = [&](int ufo_index, Vector2 const & pos) {
+        Vector2 result = stage.office().pos();
+        if (stage.ufos()[ufo_index].type() == UFOType_Small) {
+            repeat (large_ufo_index, Parameter::LargeUFOCount) {
+                Vector2 large_pos = stage.ufos()[large_ufo_index].pos();
+                if (item_count[large_ufo_index] >= Parameter::SmallUFOCapacity and pos.squareDist(large_pos) < pos.squareDist(result)) {
+                    result = large_pos;
+                }
             }
+        }
+        return result;
+    };
+    auto penalty_of = [&](int ufo_index) -> array<double, Parameter::MaxHouseCount> const & {
+        bool is_small = stage.ufos()[ufo_index].type() == UFOType_Small;
+        if (is_small and not large_penalty_ready) {
+            repeat (house_index, house_count) {
+                auto const & house = stage.houses()[house_index];
+                large_penalty[house_index] = 0;
+                repeat (large_ufo_index, Parameter::LargeUFOCount) {
+                    double large_square_dist = house.pos().squareDist(stage.ufos()[large_ufo_index].pos());
+                    if (large_square_dist < params.large_penalty_radius * params.large_penalty_radius) {
+                        large_penalty[house_index] += (params.large_penalty_radius - sqrt(large_square_dist)) / Parameter::SmallUFOMaxSpeed;
+                    }
+                }
+            }
+            large_penalty_ready = true;
+        }
+        int area = get_ufo_area(ufo_index, towns.size());
+        int key = 2 * (area + 1) + is_small;
+        auto & penalty = penalty_cache[key];
+        if (not penalty_cache_ready[key]) {
+            repeat (house_index, house_count) {
+                penalty[house_index] = area_mask[area + 1].contains(house_index) ? 0 : area_penalty;
+                if (is_small) penalty[house_index] += large_penalty[house_index];
+            }
+            penalty_cache_ready[key] = true;
+        }
+        return penalty;
+    };
+    auto refresh = [&](int ufo_index) {
+        auto const & ufo = stage.ufos()[ufo_index];
+        if (item_count[ufo_index] == 0) {
+            if (engine.is_active(ufo_index) or engine.is_pinned(ufo_index)) engine.deactivate(ufo_index);
+            if (target.is_targetting(ufo_index)) target.unlink_ufo(ufo_index);
+            return;
+        }
+        if (engine.is_pinned(ufo_index) and target.is_targetting(ufo_index)) return;
+        if (engine.is_active(ufo_index) and item_count[ufo_index] == ufo.itemCount() and stage.turn() - engine.refreshed_at(ufo_index) < stale_turn_limit) return;
 
+        // 小さいUFOは大きいUFOの近くを避ける (大きいUFOが自分で配るため)
+        auto const & penalty = penalty_of(ufo_index);
+        // 最後の1個なら、配達後に最寄りの補給場所へ戻る分も払う
+        if (item_count[ufo_index] == 1) {
+            for (int house_index : HouseSet::Range(house_count) - engine.forbidden_houses()) {
+                Vector2 house_pos = stage.houses()[house_index].pos();
+                double refill_dist = house_pos.dist(refill_point(ufo_index, house_pos));
+                refill_penalty[house_index] = penalty[house_index] + refill_weight * refill_dist / ufo.maxSpeed();
+            }
+            engine.update(ufo_index, stage.turn(), ufo.pos(), ufo.maxSpeed(), refill_penalty);
         } else {
-            // 目標の家に着いたら配達
-            if (target.is_targetting(ufo_index)) {
-                int house_index = target.from_ufo(ufo_index);
-                auto const & house = stage.houses()[house_index];
-                if (Util::IsIntersect(ufo, house)) {
-                    item_count[ufo_index] -= 1;
-                    actions.add(Action::Deliver(ufo_index, house_index));
-                    target.deliver_house(house_index);
+            engine.update(ufo_index, stage.turn(), ufo.pos(), ufo.maxSpeed(), penalty);
+        }
+    };
+    // 結果を反映
+    auto apply = [&]() {
+        repeat (ufo_index, Parameter::UFOCount) {
+            if (engine.is_pinned(ufo_index) or not engine.is_active(ufo_index)) continue;
+            int house_index = engine.house_of(ufo_index);
+            if (house_index == -1) {
+                if (target.is_targetting(ufo_index)) target.unlink_ufo(ufo_index);
+            } else if (target.from_ufo(ufo_index) != house_index) {
+                target.link(ufo_index, house_index);
+            }
+        }
+    };
+
+    // 初手は大きいUFOを先に決める
+    if (stage.turn() == 0) {
+        repeat (ufo_index, Parameter::LargeUFOCount) refresh(ufo_index);
+        engine.solve();
+        apply();
+    }
+
+    // 初手の小さいUFOは担当範囲からランダムに選んで固定する。ここが乱択の対象
+    if (stage.turn() == 0) {
+        repeat_from (ufo_index, Parameter::LargeUFOCount, Parameter::UFOCount) if (item_count[ufo_index]) {
+            int area = get_ufo_area(ufo_index, towns.size());
+            HouseSet free_houses = area_mask[area + 1] - target.assigned_houses;
+            if (not free_houses.isEmpty()) {
+                if (initial_house[ufo_index] == -1) {
+                    initial_house[ufo_index] = uniform_int_distribution<int>(0, free_houses.count() - 1)(gen);
                 }
+                int house_index = free_houses.nth(initial_house[ufo_index]);
+                target.link(ufo_index, house_index);
+                engine.pin(ufo_index, house_index);
             }
+        }
+    }
 
-            // 目標がないなら、家を宣言
-            if (item_count[ufo_index] and not target.is_targetting(ufo_index)) {
-                // 担当範囲を選択 大きいUFOへの同伴か否か
-                int target_index = -1;
-                if (ufo.type() == UFOType_Large) {
-                    if (ufo_index < towns.size()) {
-                        target_index = ufo_index;
-                    }
-                } else {
-                    int i = ufo_index - Parameter::LargeUFOCount;
-                    switch (towns.size()) {
-                        case 1: if (i < 4) target_index = 0; break;
-                        case 2: if (i < 4) target_index = i / 2; break;
-                        case 3: if (i < 2) { target_index = i; } else if (i < 6) { target_index = 2; } break;
-                        case 4:
-                        case 5: if (i < 2) target_index = i; break;
-                        default: break;
-                    }
+    bool replanned = actions.count() or engine.has_unmatched();
+    if (replanned) {
+        repeat (ufo_index, Parameter::UFOCount) refresh(ufo_index);
+        engine.solve();
+        apply();
+    }
+
+    // 割り当てられた家を起点に経路を組み、経路の先頭を次の目標にする
+    // 経路は見通しのためだけに使い、家は確保しない。割当を解き直すたびに組み直す
+    if (not replanned) return;
+    repeat (ufo_index, Parameter::UFOCount) {
+        planner.clear(ufo_index);
+        if (item_count[ufo_index] == 0 or not target.is_targetting(ufo_index) or engine.is_pinned(ufo_index)) continue;
+        auto const & ufo = stage.ufos()[ufo_index];
+        int horizon = min(item_count[ufo_index], ufo.type() == UFOType_Small ? small_route_horizon : large_route_horizon);
+        planner.push_back(ufo_index, target.from_ufo(ufo_index));
+        // 最安挿入で伸ばす。他のUFOの目標や担当範囲外の家は使わない
+        int area = get_ufo_area(ufo_index, towns.size());
+        auto const & penalty = penalty_of(ufo_index);
+        Vector2 goal = refill_point(ufo_index, travel.pos[planner.back(ufo_index)]);
+        while (planner.size(ufo_index) < horizon) {
+            int best_house = -1, best_position = -1;
+            double best_cost = INFINITY;
+            for (int house_index : area_mask[area + 1] - engine.forbidden_houses() - target.assigned_houses) {
+                if (planner.contains(ufo_index, house_index)) continue;
+                int position = 0;
+                double cost = planner.insertion_cost(ufo_index, travel, ufo.pos(), goal, refill_weight, house_index, position) / ufo.maxSpeed() + penalty[house_index];
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_house = house_index;
+                    best_position = position;
                 }
-                vector<int> const *target_house_indices_ptr;
-                if (target_index == -1) {
-                    target_house_indices_ptr = &countryside_house_indices;
-                } else {
-                    target_house_indices_ptr = &towns[target_index].house_indices;
+            }
+            if (best_house == -1) break;
+            planner.insert(ufo_index, best_position, best_house);
+        }
+        planner.improve(ufo_index, travel, ufo.pos(), goal, refill_weight);
+        if (target.from_ufo(ufo_index) != planner.front(ufo_index)) target.link(ufo_index, planner.front(ufo_index));
+    }
+}
+
+/// Q16 固定小数点の運動モデル。先読みの選別用です。
+///
+/// 座標を 2^16 倍した整数で持ち、距離の比較と速度の制限を整数で行うので、コンパイラや最適化によらず同じ結果になります。
+/// 1ターンの移動での UFO::move との差は STEP_ERROR 以下です。
+/// 移動 p -> p + clamp(t - p) は非拡大なので、同じ目標を辿る n ターン後の差は n * STEP_ERROR 以下に収まります。
+/// 出力する行動は必ず Stage の float の移動で確かめ直します。
+namespace fixed_kinematics {
+    constexpr int SHIFT = 16;
+    constexpr ll ONE = 1ll << SHIFT;
+    /// 1ターンで生じる UFO::move との差の上限(Q16)。
+    /// float の引き算と足し算の丸めが各成分 2^-15 ずつ、平方根の切り捨てと割り算の丸めが各成分 1.5 単位。
+    constexpr ll STEP_ERROR = 8;
+    struct vec_t { int x, y; };
+    inline int to_fixed(float a) { return int(lrint(a * ONE)); }
+    inline vec_t to_fixed(Vector2 const & a) { return { to_fixed(a.x), to_fixed(a.y) }; }
+    inline float to_float(int a) { return a / float(ONE); }
+    inline Vector2 to_float(vec_t const & a) { return Vector2(to_float(a.x), to_float(a.y)); }
+    /// floor(sqrt(n))。double の sqrt は正しく丸められるので、±1 の補正で厳密になります。
+    inline ll isqrt(ll n) {
+        ll r = sqrt(double(n));
+        while (r * r > n) -- r;
+        while ((r + 1) * (r + 1) <= n) ++ r;
+        return r;
+    }
+    inline ll square_dist(vec_t const & a, vec_t const & b) {
+        ll dx = a.x - b.x;
+        ll dy = a.y - b.y;
+        return dx * dx + dy * dy;
+    }
+    /// 距離が reach 以下か。reach は整数の長さ。
+    inline bool is_within(vec_t const & a, vec_t const & b, int reach) {
+        return square_dist(a, b) <= (ll(reach) * reach << (2 * SHIFT));
+    }
+    /// 最大速度 max_speed で target へ1ターン進みます。UFO::move に対応します。
+    inline vec_t move(vec_t const & pos, vec_t const & target, int max_speed) {
+        ll dx = target.x - pos.x;
+        ll dy = target.y - pos.y;
+        ll speed = ll(max_speed) << SHIFT;
+        ll square = dx * dx + dy * dy;
+        if (square > speed * speed) {
+            ll length = isqrt(square);
+            auto scale = [&](ll d) { ll n = d * speed; return (n >= 0 ? n + length / 2 : n - length / 2) / length; };
+            dx = scale(dx);
+            dy = scale(dy);
+        }
+        return { int(pos.x + dx), int(pos.y + dy) };
+    }
+#ifdef LOCAL
+    // 上限の確認。盤面全体の乱択した点の間を、小さいUFOの速さで折り返し辿ります。
+    unittest {
+        mt19937 engine;
+        uniform_real_distribution<float> coord(0, Parameter::StageWidth);
+        repeat (trial, 200) {
+            int speed = trial % 2 ? Parameter::SmallUFOMaxSpeed : Parameter::LargeUFOMaxSpeed;
+            UFO ufo(UFOType_Small, Vector2(coord(engine), coord(engine)), Parameter::SmallUFORadius, speed, Parameter::SmallUFOCapacity);
+            vec_t pos = to_fixed(ufo.pos());
+            int turn = 0;
+            repeat (leg, 4) {
+                Vector2 target(coord(engine), coord(engine));
+                vec_t fixed_target = to_fixed(target);
+                repeat (step, 80) {
+                    ufo.move(target);
+                    pos = move(pos, fixed_target, speed);
+                    ++ turn;
+                    ll bound = turn * STEP_ERROR + 1;
+                    assert (square_dist(pos, to_fixed(ufo.pos())) <= bound * bound);
                 }
+            }
+        }
+    }
+#endif
+}
 
-                // 一番近いものを選択
-                int nearest_house_index = -1;
-                double nearest_house_distance = INFINITY;
-                auto update = [&](int house_index) {
-                    if (target.is_delivered(house_index)) return;
-                    auto const & house = stage.houses()[house_index];
-                    if (target.from_house(house_index) == TargetManager::NONE) {
-                        double dist = ufo.pos().dist(house.pos());
-                        if (ufo.type() == UFOType_Small) {
-                            repeat (large_ufo_index, Parameter::LargeUFOCount) {
-                                auto const & large_ufo = stage.ufos()[large_ufo_index];
-                                double large_dist = house.pos().dist(large_ufo.pos());
-                                dist += max(0.0, 100 - large_dist);
-                            }
-                        }
-                        if (dist < nearest_house_distance) {
-                            nearest_house_distance = dist;
-                            nearest_house_index = house_index;
-                        }
-                    }
-                };
-                if (ufo.type() == UFOType_Small and stage.turn() == 0) {
-                    vector<int> house_indices;
-                    for (int house_index : *target_house_indices_ptr) {
-                        if (target.from_house(house_index) == TargetManager::NONE) {
-                            house_indices.push_back(house_index);
-                        }
-                    }
-                    if (not house_indices.empty()) {
-                        if (initial_house[ufo_index] == -1) {
-                            initial_house[ufo_index] = uniform_int_distribution<int>(0, house_indices.size() - 1)(gen);
-                        }
-                        nearest_house_index = house_indices[initial_house[ufo_index]];
-                    }
-                } else {
-                    for (int house_index : *target_house_indices_ptr) {
-                        update(house_index);
-                    }
+/// 空になった小さいUFOが、どこで補給を受けるかを決めます。
+///
+/// 大きいUFOは予定の目標を順に辿るとして軌跡を先読みし、小さいUFOが最も早く接触できるターンと目指す点を求めます。
+/// 農場へ戻る場合とも比べます。全ての 小さいUFO x 大きいUFO の組を一度に解きます。
+/// 軌跡と接触の判定は fixed_kinematics で行います。
+struct intercept_solver_t {
+    enum { HORIZON = 64 };  // これより先の合流は考えない。盤面の端から端まで小さいUFOで約70ターン
+    int horizon;  // 軌跡を作るターン数。農場へ戻る方が早いターンより先は要らない
+    int large_count;  // 補給元になれる大きいUFOの数
+    array<int, Parameter::LargeUFOCount> large_index;
+    array<array<int, HORIZON + 1>, Parameter::LargeUFOCount> track_x, track_y;  // [large][turn] Q16
+
+    struct result_t {
+        int turn;         ///< 接触できるターン数
+        int large_index;  ///< 補給元の大きいUFO。農場なら -1
+        fixed_kinematics::vec_t pos;  ///< 目指す点 (Q16)。接触するターンの大きいUFOの予測位置か、農場
+    };
+
+    /// 農場へ戻るのにかかるターン数。
+    static int office_turn(Stage const & stage, Vector2 const & pos) {
+        float office_reach = Parameter::SmallUFORadius + Parameter::OfficeRadius;
+        return ceil(max(0.0f, pos.dist(stage.office().pos()) - office_reach) / Parameter::SmallUFOMaxSpeed);
+    }
+    /// 箱を持たない小さいUFOの位置から、調べるターン数を決めます。
+    void reset(Stage const & stage) {
+        large_count = 0;
+        horizon = 0;
+        repeat_from (ufo_index, Parameter::LargeUFOCount, Parameter::UFOCount) if (stage.ufos()[ufo_index].itemCount() == 0) {
+            horizon = max(horizon, office_turn(stage, stage.ufos()[ufo_index].pos()));
+        }
+        horizon = min<int>(horizon, HORIZON);
+    }
+    /// 大きいUFOの軌跡を登録します。
+    ///
+    /// aims[i] へ向かって最大速度で進み、centers[i] の家に触れたら次へ移ります。最後の点に着いたら留まります。
+    void add_large(int ufo_index, UFO const & ufo, Vector2 const * aims, Vector2 const * centers, int waypoint_count) {
+        using namespace fixed_kinematics;
+        int k = large_count ++;
+        large_index[k] = ufo_index;
+        int reach = Parameter::LargeUFORadius + Parameter::HouseRadius;
+        int speed = Parameter::LargeUFOMaxSpeed;
+        vec_t pos = to_fixed(ufo.pos());
+        vec_t aim = {}, center = {};
+        int i = -1;
+        int turn = 0;
+        for (; turn <= horizon; ++ turn) {
+            track_x[k][turn] = pos.x;
+            track_y[k][turn] = pos.y;
+            // 受け渡しは移動の前に起きる
+            while (i < waypoint_count) {
+                if (i >= 0 and not is_within(pos, center, reach)) break;
+                if (++ i < waypoint_count) {
+                    aim = to_fixed(aims[i]);
+                    center = to_fixed(centers[i]);
                 }
-                if (nearest_house_index == -1) {
-                    repeat (house_index, house_count) {
-                        update(house_index);  // 担当範囲が空なら他のをやる
-                    }
+            }
+            if (i == waypoint_count) break;
+            pos = move(pos, aim, speed);
+        }
+        // 最後の家に着いた後は、その場に留まるとみなす
+        for (++ turn; turn <= horizon; ++ turn) {
+            track_x[k][turn] = pos.x;
+            track_y[k][turn] = pos.y;
+        }
+    }
+    /// 箱を持たない小さいUFOそれぞれについて、最も早く補給できる場所を求めます。
+    void solve(Stage const & stage, array<result_t, Parameter::UFOCount> & results) const {
+        using namespace fixed_kinematics;
+        ll speed = Parameter::SmallUFOMaxSpeed;
+        ll large_reach = Parameter::SmallUFORadius + Parameter::LargeUFORadius;
+        // turn ターン後に届く距離の二乗(Q32)
+        array<ll, HORIZON + 1> reachable;
+        repeat (turn, horizon + 1) reachable[turn] = (speed * turn + large_reach) * (speed * turn + large_reach) << (2 * SHIFT);
+        repeat_from (ufo_index, Parameter::LargeUFOCount, Parameter::UFOCount) if (stage.ufos()[ufo_index].itemCount() == 0) {
+            vec_t pos = to_fixed(stage.ufos()[ufo_index].pos());
+            auto & result = results[ufo_index];
+            result.turn = office_turn(stage, stage.ufos()[ufo_index].pos());
+            result.large_index = -1;
+            result.pos = to_fixed(stage.office().pos());
+            repeat (k, large_count) {
+                // 今の最善より早いターンだけを、分岐なしで調べて最初に届くターンを拾う
+                int limit = min(horizon + 1, result.turn);
+                array<bool, HORIZON + 1> ok;
+                repeat (turn, limit) {
+                    ll dx = track_x[k][turn] - pos.x;
+                    ll dy = track_y[k][turn] - pos.y;
+                    ok[turn] = dx * dx + dy * dy <= reachable[turn];
                 }
-                if (nearest_house_index != -1) {
-                    target.link(ufo_index, nearest_house_index);
+                int turn = find(ok.begin(), ok.begin() + limit, true) - ok.begin();
+                if (turn < limit) {
+                    result.turn = turn;
+                    result.large_index = large_index[k];
+                    result.pos = vec_t { track_x[k][turn], track_y[k][turn] };
                 }
             }
+        }
+    }
+};
 
-            // 目標がないなら、他のUFOから貪欲に奪う
-            if (item_count[ufo_index] and not target.is_targetting(ufo_index)) {
-                repeat (other_ufo_index, Parameter::UFOCount) if (target.is_targetting(other_ufo_index)) {
-                    auto const & other_ufo = stage.ufos()[other_ufo_index];
-                    int house_index = target.from_ufo(other_ufo_index);
-                    auto const & house = stage.houses()[house_index];
-                    double this_time = ufo.pos().dist(house.pos()) / ufo.maxSpeed();
-                    double other_time = other_ufo.pos().dist(house.pos()) / other_ufo.maxSpeed();
-                    if (this_time < other_time) {
-                        target.unlink_ufo(other_ufo_index);
-                        target.link(ufo_index, house_index);
-                        break;
+void move_ufos_with_towns(Stage const & stage, TargetPositions & target_positions, TargetManager & target, route_planner_t const & planner, scratch_vector<town_t> const & towns) {
+    array<Vector2, Parameter::UFOCount> target_pos;
+    intercept_solver_t intercept;
+    intercept.reset(stage);
+    bool needs_refill = intercept.horizon > 0;  // 農場に接している空のUFOは農場で補給する
+    repeat (ufo_index, Parameter::UFOCount) {
+        auto const & ufo = stage.ufos()[ufo_index];
+        auto & pos = target_pos[ufo_index];
+
+        // アイテムがないなら補給へ。小さいUFOは後でまとめて決める
+        if (ufo.itemCount() == 0) {
+            pos = stage.office().pos();
+
+        } else {
+            // 家へ向かう
+            int house_index = target.from_ufo(ufo_index);
+            if (house_index != TargetManager::NONE) {
+                // 経路に次の家があるなら、目標の家に触れられる範囲で次の家の側へ寄せる
+                pos = stage.houses()[house_index].pos();
+                if (planner.size(ufo_index) >= 2 and planner.front(ufo_index) == house_index) {
+                    Vector2 dir = stage.houses()[planner.at(ufo_index, 1)].pos() - pos;
+                    float reach = 0.9f * (ufo.radius() + Parameter::HouseRadius);
+                    if (not dir.isZeroStrict()) pos += dir.unit(min(reach, dir.length()));
+                }
+
+            // 暇なら待機
+            } else {
+                pos = ufo.pos();
+            }
+        }
+
+        // 小さいUFOに渡せるだけの箱がある大きいUFOは、予定の経路を辿るとして軌跡を登録する
+        if (needs_refill and ufo.type() == UFOType_Large and ufo.itemCount() >= Parameter::SmallUFOCapacity) {
+            array<Vector2, Parameter::LargeUFOCapacity + 1> aims, centers;
+            int waypoint_count = 0;
+            int house_index = target.from_ufo(ufo_index);
+            if (house_index != TargetManager::NONE) {
+                aims[0] = pos;
+                centers[0] = stage.houses()[house_index].pos();
+                waypoint_count = 1;
+                if (planner.size(ufo_index) and planner.front(ufo_index) == house_index) {
+                    repeat_from (i, 1, planner.size(ufo_index)) {
+                        aims[waypoint_count] = centers[waypoint_count] = stage.houses()[planner.at(ufo_index, i)].pos();
+                        waypoint_count += 1;
                     }
                 }
             }
+            intercept.add_large(ufo_index, ufo, aims.data(), centers.data(), waypoint_count);
+        }
+    }
+
+    // 空の小さいUFOは、大きいUFOとの合流と農場のうち早い方へ。合流点は毎ターン求め直す
+    if (needs_refill) {
+        array<intercept_solver_t::result_t, Parameter::UFOCount> refill;
+        intercept.solve(stage, refill);
+        repeat_from (ufo_index, Parameter::LargeUFOCount, Parameter::UFOCount) if (stage.ufos()[ufo_index].itemCount() == 0) {
+            int large_ufo_index = refill[ufo_index].large_index;
+            if (large_ufo_index == -1) {
+                target_pos[ufo_index] = stage.office().pos();
+            } else if (params.refill_aim) {
+                target_pos[ufo_index] = fixed_kinematics::to_float(refill[ufo_index].pos);
+            } else {
+                target_pos[ufo_index] = stage.ufos()[large_ufo_index].pos();
+            }
         }
     }
+
+    repeat (ufo_index, Parameter::UFOCount) target_positions.add(target_pos[ufo_index]);
 }
 
-void move_ufos_with_towns(Stage const & stage, TargetPositions & target_positions, TargetManager & target, vector<town_t> const & towns) {
+struct turn_output_t {
+    Actions actions;
+    TargetPositions target_positions;
+};
+
+/// 1回のロールアウトの途中状態です。ビームサーチのノードにもなります。
+struct rollout_state_t {
+    Stage stage;
+    TargetManager target;
+    assignment_engine_t engine;
+    route_planner_t planner;
+    explicit rollout_state_t(Stage const & a_stage) : stage(a_stage) {
+        engine.reset(stage.houses());
+        planner.reset();
+    }
+};
+
+/// 1ターン進めます。initial_house は初手の小さいUFOの行き先で、-1 ならランダムに決めて書き戻します。
+void advance(rollout_state_t & state, turn_output_t & output, travel_matrix_t const & travel, scratch_vector<town_t> const & towns, area_mask_t const & area_mask, initial_house_t & initial_house) {
+    Stage & stage = state.stage;
+    TargetManager & target = state.target;
+    move_items_with_towns(stage, output.actions, target, state.engine, state.planner, travel, towns, area_mask, initial_house);
+    stage.moveItems(output.actions);
+    move_ufos_with_towns(stage, output.target_positions, target, state.planner, towns);
+    stage.moveUFOs(output.target_positions);
+    stage.advanceTurn();
+    HPC_STATS_ADD(simulatedTurns, 1);
+
+#ifdef DEBUG
+        // debug
+cerr << "turn " << stage.turn() << ": ";
+repeat (house_index, stage.houses().count()) cerr << stage.houses()[house_index].delivered();
+cerr << " / ";
+repeat (ufo_index, Parameter::UFOCount) cerr << target.from_ufo(ufo_index) << "(" << stage.ufos()[ufo_index].itemCount() << ") ";
+cerr << endl;
+#endif
+
+#ifdef LOCAL
+    // check invariant
+    repeat (ufo_index, Parameter::UFOCount) {
+        int house_index = target.from_ufo(ufo_index);
+        if (house_index == TargetManager::NONE) {
+            // nop
+        } else if (house_index == TargetManager::DELIVERED) {
+            assert (false);
+        } else {
+            assert (target.from_house(house_index) == ufo_index);
+        }
+    }
+    repeat (house_index, stage.houses().count()) {
+        int ufo_index = target.from_house(house_index);
+        if (ufo_index == TargetManager::NONE) {
+            // nop
+        } else if (ufo_index == TargetManager::DELIVERED) {
+            assert (stage.houses()[house_index].delivered());
+        } else {
+            assert (target.from_ufo(ufo_index) == house_index);
+        }
+    }
+#endif
+}
+
+/// このターンから続けて、受け渡しが起きないと保証できるターン数を求めます。
+///
+/// 受け渡しがなく割当に空きもないターンは、move_items_with_towns が何もしません。
+/// 次に起きうるのは、補給の要るUFOが農場に触れる、補給の要る小さいUFOが大きいUFOに触れる、箱を持つUFOが目標の家に触れる、のどれかです。
+/// 今の距離から、近づく速さの和で触れるまでのターン数を見積もり、その最小をまとめて進めるターン数にします。
+///
+/// @param[in] limit 返すターン数の上限。
+/// @return このターンに何か起きうるなら 0。
+int count_quiet_turns(rollout_state_t const & state, int limit) {
+    Stage const & stage = state.stage;
+    if (stage.turn() == 0 or state.engine.has_unmatched()) return 0;
+    // 1ターンの移動の float の丸めと、距離の比較の誤差の分だけ余裕を見る
+    const double speed_margin = 1e-2;
+    const double reach_margin = 1e-2;
+    int quiet = limit;
+    // 今は触れていないことを確かめ、j ターン後に触れうる最小の j を quiet に反映する
+    auto bound = [&](Vector2 const & a, Vector2 const & b, float reach, double speed) {
+        float square = a.squareDist(b);
+        if (square <= reach * reach) return false;
+        if (speed > 0) {
+            double gap = sqrt(double(square)) - reach - reach_margin;
+            int turns = gap <= 0 ? 1 : int(ceil(gap / (speed + speed_margin)));
+            setmin(quiet, turns);
+        }
+        return true;
+    };
+    // 箱を持っていて目標のないUFOは、その場に留まる
+    array<double, Parameter::UFOCount> speed;
+    repeat (ufo_index, Parameter::UFOCount) {
+        auto const & ufo = stage.ufos()[ufo_index];
+        bool is_idle = ufo.itemCount() != 0 and state.target.from_ufo(ufo_index) == TargetManager::NONE;
+        speed[ufo_index] = is_idle ? 0 : ufo.maxSpeed();
+    }
     repeat (ufo_index, Parameter::UFOCount) {
         auto const & ufo = stage.ufos()[ufo_index];
+        if (ufo.itemCount() < ufo.capacity()) {
+            if (not bound(ufo.pos(), stage.office().pos(), ufo.radius() + stage.office().radius(), speed[ufo_index])) return 0;
+            if (ufo.type() == UFOType_Small) {
+                repeat (large_ufo_index, Parameter::LargeUFOCount) {
+                    auto const & large_ufo = stage.ufos()[large_ufo_index];
+                    if (not bound(ufo.pos(), large_ufo.pos(), ufo.radius() + large_ufo.radius(), speed[ufo_index] + speed[large_ufo_index])) return 0;
+                }
+            }
+        }
+        int house_index = state.target.from_ufo(ufo_index);
+        if (ufo.itemCount() and house_index != TargetManager::NONE) {
+            auto const & house = stage.houses()[house_index];
+            if (not bound(ufo.pos(), house.pos(), ufo.radius() + house.radius(), speed[ufo_index])) return 0;
+        }
+    }
+    return quiet;
+}
+
+/// 受け渡しの起きないターンを turns ターンまとめて進めます。
+///
+/// 受け渡しフェーズと割当は飛ばし、UFOの移動は Stage のものを毎ターン使うので、1ターンずつ advance した場合と同じ状態になります。
+/// 目標は空の小さいUFOがいなければ変わらないので1度だけ求め、いれば合流点を毎ターン求め直します。
+/// outputs には各ターンの出力を積みます。
+void advance_quiet(rollout_state_t & state, scratch_vector<turn_output_t> & outputs, int turns, scratch_vector<town_t> const & towns) {
+    Stage & stage = state.stage;
+    bool is_chasing = false;
+    repeat_from (ufo_index, Parameter::LargeUFOCount, Parameter::UFOCount) {
+        if (stage.ufos()[ufo_index].itemCount() == 0) is_chasing = true;
+    }
+    turn_output_t output = {};
+    repeat (turn, turns) {
+        if (turn == 0 or is_chasing) {
+            output.target_positions.clear();
+            move_ufos_with_towns(stage, output.target_positions, state.target, state.planner, towns);
+        }
+#ifdef LOCAL
+        // 見積もりが正しければ、move_items_with_towns は何もしない
+        repeat (ufo_index, Parameter::UFOCount) {
+            auto const & ufo = stage.ufos()[ufo_index];
+            if (ufo.itemCount() < ufo.capacity()) {
+                assert (not Util::IsIntersect(ufo, stage.office()));
+                if (ufo.type() == UFOType_Small) {
+                    repeat (large_ufo_index, Parameter::LargeUFOCount) assert (not Util::IsIntersect(ufo, stage.ufos()[large_ufo_index]));
+                }
+            }
+            int house_index = state.target.from_ufo(ufo_index);
+            if (ufo.itemCount() and house_index != TargetManager::NONE) assert (not Util::IsIntersect(ufo, stage.houses()[house_index]));
+        }
+#endif
+        stage.moveUFOs(output.target_positions);
+        stage.advanceTurn();
+        outputs.push_back(output);
+    }
+    HPC_STATS_ADD(simulatedTurns, turns);
+    HPC_STATS_ADD(macroSteps, 1);
+    HPC_STATS_ADD(macroTurns, turns);
+}
+
+/// 残りのターン数の下界を求めます。ロールアウトの分枝限定に使います。
+///
+/// 未配達の家には、どれかのUFOが触れた次のターンの受け渡しフェーズで配ることになります。
+/// また、全UFOの箱が未配達の家より少なければ、どれかのUFOが農場に寄る必要があります。
+/// 箱はどのUFOの間でも渡せ、農場での積み込みと受け渡しと配達は同じフェーズで続けて起こりうるので、
+/// 箱を持たないUFOにも補給のための寄り道は数えません。
+int remaining_turns_lower_bound(Stage const & stage) {
+    // 浮動小数の誤差で下界を超えないよう、少しだけ切り捨て側に寄せる
+    auto turns_to_touch = [](float gap, float speed) {
+        return gap <= 0 ? 0 : int(ceil(gap / speed - 1e-3f));
+    };
+    Vector2 office = stage.office().pos();
+    int item_count = 0;
+    int to_office = Parameter::GameTurnLimit;
+    repeat (ufo_index, Parameter::UFOCount) {
+        auto const & ufo = stage.ufos()[ufo_index];
+        item_count += ufo.itemCount();
+        setmin(to_office, turns_to_touch(ufo.pos().dist(office) - ufo.radius() - Parameter::OfficeRadius, ufo.maxSpeed()));
+    }
+    int house_count = stage.undeliveredHouses().count();
+    int bound = 0;
+    for (int house_index : stage.undeliveredHouses()) {
+        auto const & house = stage.houses()[house_index];
+        int nearest = Parameter::GameTurnLimit;
+        repeat (ufo_index, Parameter::UFOCount) {
+            auto const & ufo = stage.ufos()[ufo_index];
+            float reach = ufo.radius() + Parameter::HouseRadius;
+            setmin(nearest, turns_to_touch(ufo.pos().dist(house.pos()) - reach, ufo.maxSpeed()));
+        }
+        setmax(bound, nearest);
+    }
+    if (house_count == 0) return 0;
+    if (item_count < house_count) setmax(bound, to_office);
+    return bound + 1;
+}
+
+/// 探索の方式。両方を指定すると、ランダムな再試行の結果をビームサーチの打ち切りに使います。
+/// 今の評価関数ではビームサーチ単独はランダムな再試行に及ばないので、既定では使いません。
+/// 手元での比較用の解答が init の間だけ切り替えるので、定数にはしていません。
+enum search_mode_t {
+    SearchRestart = 1 << 0,
+    SearchBeam = 1 << 1,
+};
+thread_local int search_mode = SearchRestart;
+/// 各ノードから作る子の数。1つは割当をそのまま使い、残りは小さいUFOの行き先を1つ固定して変えます。
+const int beam_branch = 4;
+const int beam_max_width = 128;
+/// ビームサーチで1ステージあたりに展開するノードの数。幅は残りのノード数を残りのターンで割って毎ターン決めます。
+/// 時間ではなくノード数で決めるので、同じステージなら実行ごとやスレッド数によらず同じ結果になります。
+const int beam_node_budget = 2000;
+/// 状態の同一視で、UFOの座標を丸める格子の大きさ。
+const int zobrist_cell = 8;
 
-        // アイテムがないなら最寄りの補給可能場所へ
+/// 状態の Zobrist hash を計算します。
+///
+/// 配達済みの家、格子に丸めたUFOの座標、UFOの箱の数から作ります。
+struct zobrist_t {
+    enum { CELL_W = (Parameter::StageWidth + zobrist_cell - 1) / zobrist_cell, CELL_H = (Parameter::StageHeight + zobrist_cell - 1) / zobrist_cell };
+    array<uint64_t, Parameter::MaxHouseCount> delivered;
+    array<array<uint64_t, CELL_W * CELL_H>, Parameter::UFOCount> pos;
+    array<array<uint64_t, Parameter::LargeUFOCapacity + 1>, Parameter::UFOCount> item_count;
+
+    zobrist_t() {
+        mt19937_64 engine;  // 既定のシードで固定し、実行ごとに同じ表にする
+        for (auto & it : delivered) it = engine();
+        for (auto & row : pos) for (auto & it : row) it = engine();
+        for (auto & row : item_count) for (auto & it : row) it = engine();
+    }
+    uint64_t operator () (Stage const & stage) const {
+        uint64_t h = 0;
+        for (int house_index : stage.deliveredHouses()) h ^= delivered[house_index];
+        repeat (ufo_index, Parameter::UFOCount) {
+            auto const & ufo = stage.ufos()[ufo_index];
+            int x = min<int>(CELL_W - 1, max(0, int(ufo.pos().x) / zobrist_cell));
+            int y = min<int>(CELL_H - 1, max(0, int(ufo.pos().y) / zobrist_cell));
+            h ^= pos[ufo_index][y * CELL_W + x];
+            h ^= item_count[ufo_index][ufo.itemCount()];
+        }
+        return h;
+    }
+};
+
+/// ビームサーチの評価値。配達済みの家の数を主に、各UFOが次の目的地に着くまでのターン数を従にします。
+double evaluate_state(rollout_state_t const & state) {
+    Stage const & stage = state.stage;
+    double score = 100 * stage.deliveredHouses().count();
+    repeat (ufo_index, Parameter::UFOCount) {
+        auto const & ufo = stage.ufos()[ufo_index];
+        int house_index = state.target.from_ufo(ufo_index);
         if (ufo.itemCount() == 0) {
-            Vector2 pos = stage.office().pos();
+            score -= ufo.pos().dist(stage.office().pos()) / ufo.maxSpeed();
+        } else if (house_index >= 0) {
+            score -= ufo.pos().dist(stage.houses()[house_index].pos()) / ufo.maxSpeed();
+        }
+    }
+    return score;
+}
+
+/// UFOの行き先を家に固定します。
+void pin_house(rollout_state_t & state, int ufo_index, int house_index) {
+    state.target.link(ufo_index, house_index);
+    state.engine.pin(ufo_index, house_index);
+}
+
+/// 補給したばかりの小さいUFOを1つ選び、近くの空いている家の1つへ固定します。初手のランダムな固定と同じ考え方です。
+/// 固定したUFOと家を返します。固定できなければ何もせず (-1, -1) を返します。
+pair<int, int> perturb_state(rollout_state_t & state, area_mask_t const & area_mask, int town_count) {
+    Stage const & stage = state.stage;
+    int ufo_index = uniform_int_distribution<int>(Parameter::LargeUFOCount, Parameter::UFOCount - 1)(gen);
+    auto const & ufo = stage.ufos()[ufo_index];
+    if (ufo.itemCount() != ufo.capacity() or state.engine.is_pinned(ufo_index)) return make_pair(-1, -1);
+    int area = get_ufo_area(ufo_index, town_count);
+    const int candidate_count = 4;
+    array<pair<float, int>, candidate_count> candidates;
+    int size = 0;
+    for (int house_index : area_mask[area + 1] - state.engine.forbidden_houses() - state.target.assigned_houses) {
+        auto it = make_pair(ufo.pos().squareDist(stage.houses()[house_index].pos()), house_index);
+        if (size < candidate_count) {
+            candidates[size ++] = it;
+        } else if (it < *max_element(candidates.begin(), candidates.end())) {
+            *max_element(candidates.begin(), candidates.end()) = it;
+        }
+    }
+    if (size == 0) return make_pair(-1, -1);
+    int house_index = candidates[uniform_int_distribution<int>(0, size - 1)(gen)].second;
+    pin_house(state, ufo_index, house_index);
+    return make_pair(ufo_index, house_index);
+}
+
+/// ビームサーチで出力の列を作ります。incumbent ターン未満で終わる列が見つからなければ空を返します。
+vector<turn_output_t> beam_search(Stage const & a_stage, travel_matrix_t const & travel, scratch_vector<town_t> const & towns, area_mask_t const & area_mask, int incumbent) {
+    static const zobrist_t zobrist;
+    struct node_t {
+        rollout_state_t state;
+        int history;  // 直前の出力の位置
+        double score;
+    };
+    struct history_t {
+        int parent;
+        turn_output_t output;
+    };
+    vector<history_t> history;
+    vector<node_t> beam;
+    beam.push_back({ rollout_state_t(a_stage), -1, 0 });
+    HPC_STATS_ADD(rollouts, 1);
+    int rest_nodes = beam_node_budget;
+    repeat (turn, incumbent - 1) {
+        int width = max(1, min(beam_max_width, rest_nodes / max(1, incumbent - 1 - turn)));
+        vector<node_t> children;
+        unordered_set<uint64_t> used;
+        for (auto const & node : beam) {
+            repeat (branch, beam_branch) {
+                node_t child = node;
+                initial_house_t initial_house;
+                fill(whole(initial_house), -1);
+                if (turn != 0 and branch != 0) perturb_state(child.state, area_mask, towns.size());
+                turn_output_t output = {};
+                advance(child.state, output, travel, towns, area_mask, initial_house);
+                if (not used.insert(zobrist(child.state.stage)).second) continue;
+                history.push_back({ node.history, output });
+                child.history = history.size() - 1;
+                if (child.state.stage.hasFinished()) {
+                    vector<turn_output_t> outputs;
+                    for (int i = child.history; i != -1; i = history[i].parent) outputs.push_back(history[i].output);
+                    reverse(whole(outputs));
+                    return outputs;
+                }
+                child.score = evaluate_state(child.state);
+                children.push_back(child);
+            }
+        }
+        if (children.empty()) break;
+        // 上位 width 個を残す
+        if (int(children.size()) > width) {
+            nth_element(children.begin(), children.begin() + width, children.end(), [](node_t const & a, node_t const & b) { return a.score > b.score; });
+            children.erase(children.begin() + width, children.end());
+        }
+        rest_nodes -= beam.size();
+        beam.swap(children);
+        if (rest_nodes <= 0) break;
+    }
+    return vector<turn_output_t>();
+}
+
+/// 焼きなましを使うか。ランダムな再試行の最良の結果から配達順序を取り出して改善します。
+/// search_mode と同じく、比較用の解答が切り替えます。
+thread_local bool use_anneal = true;
+const int anneal_iteration = 100000;
+/// 温度はターン数の単位。線形に 0 まで下げます。見積もりと実際のずれが大きいので、ほぼ山登りにした方が良い。
+const double anneal_initial_temperature = 0.05;
+/// 最も遅いUFO以外の費用にかける重み。最も遅いUFOが同じ計画どうしを比べるために使います。
+const double anneal_sum_weight = 0.05;
+/// シミュレーションで確かめる回数。最良の計画がその間に良くなっていれば、区切りごとに確かめます。
+const int anneal_validation_count = 32;
+
+/// UFOごとの配達順序だけで表した計画です。
+///
+/// UFOは順序どおりに家へ配り、箱がなくなるたびに補給場所へ寄ります。
+/// 費用は移動のターン数の見積もりで、家の列の位置 p へ入る区間の費用を leg(u, p) とします。
+/// 補給は容量ごとの区切りで起きるので、どの区間の費用も前後の家だけで決まります。
+/// そのため移動の差分は、変えた位置の周り (区間を動かす移動なら、その区間) だけを足し直せば求まります。
+struct sequence_plan_t {
+    array<scratch_vector<int>, Parameter::UFOCount> sequence;
+    array<double, Parameter::UFOCount> cost;
+    array<Vector2, Parameter::UFOCount> start;
+    array<int, Parameter::UFOCount> capacity;
+    array<float, Parameter::UFOCount> inv_speed;
+    /// 家ごとに寄る補給場所を1つ決めておきます。[type][house]
+    array<array<float, Parameter::MaxHouseCount>, 2> refill_dist;
+    array<array<Vector2, Parameter::MaxHouseCount>, 2> refill_pos;
+    travel_matrix_t const * travel;
+
+    /// 補給場所の候補は農場と、大きいUFOが受け持つ家の重心です。小さいUFOだけが大きいUFOから補給できます。
+    void reset(Stage const & stage, travel_matrix_t const & a_travel) {
+        travel = &a_travel;
+        repeat (ufo_index, Parameter::UFOCount) {
+            auto const & ufo = stage.ufos()[ufo_index];
+            start[ufo_index] = ufo.pos();
+            capacity[ufo_index] = ufo.capacity();
+            inv_speed[ufo_index] = 1.0f / ufo.maxSpeed();
+        }
+        array<Vector2, Parameter::LargeUFOCount> home;
+        repeat (large_ufo_index, Parameter::LargeUFOCount) {
+            auto const & seq = sequence[large_ufo_index];
+            home[large_ufo_index] = stage.office().pos();
+            if (seq.empty()) continue;
+            Vector2 sum;
+            for (int house_index : seq) sum += travel->pos[house_index];
+            home[large_ufo_index] = sum / seq.size();
+        }
+        repeat (house_index, travel->house_count) {
+            Vector2 pos = travel->pos[house_index];
+            repeat (type, 2) {
+                refill_pos[type][house_index] = stage.office().pos();
+                refill_dist[type][house_index] = pos.dist(stage.office().pos());
+            }
+            repeat (large_ufo_index, Parameter::LargeUFOCount) {
+                float dist = pos.dist(home[large_ufo_index]);
+                if (dist < refill_dist[UFOType_Small][house_index]) {
+                    refill_dist[UFOType_Small][house_index] = dist;
+                    refill_pos[UFOType_Small][house_index] = home[large_ufo_index];
+                }
+            }
+        }
+        repeat (ufo_index, Parameter::UFOCount) cost[ufo_index] = range_cost(ufo_index, 0, sequence[ufo_index].size());
+    }
+    int type_of(int ufo_index) const { return ufo_index < Parameter::LargeUFOCount ? UFOType_Large : UFOType_Small; }
+    /// 列の位置 p の家へ入る区間のターン数。
+    double leg(int ufo_index, int p) const {
+        auto const & seq = sequence[ufo_index];
+        int house_index = seq[p];
+        if (p == 0) return start[ufo_index].dist(travel->pos[house_index]) * inv_speed[ufo_index];
+        int prev = seq[p - 1];
+        if (p % capacity[ufo_index] != 0) return travel->dist[prev][house_index] * inv_speed[ufo_index];
+        int type = type_of(ufo_index);
+        return (refill_dist[type][prev] + refill_pos[type][prev].dist(travel->pos[house_index])) * inv_speed[ufo_index];
+    }
+    /// 位置 [l, r) の区間の費用の和。範囲外は無視します。
+    double range_cost(int ufo_index, int l, int r) const {
+        l = max(l, 0);
+        r = min<int>(r, sequence[ufo_index].size());
+        double acc = 0;
+        repeat_from (p, l, r) acc += leg(ufo_index, p);
+        return acc;
+    }
+    double objective() const {
+        return *max_element(whole(cost)) + anneal_sum_weight * accumulate(whole(cost), 0.0);
+    }
+};
+
+/// 計画に従って1ターン分の行動を決めます。next[u] はUFO u が次に配る家の列の位置です。
+void follow_plan(Stage const & stage, sequence_plan_t const & plan, array<int, Parameter::UFOCount> & next, turn_output_t & output) {
+    array<int, Parameter::UFOCount> item_count;
+    repeat (ufo_index, Parameter::UFOCount) {
+        auto const & ufo = stage.ufos()[ufo_index];
+        auto const & seq = plan.sequence[ufo_index];
+        item_count[ufo_index] = ufo.itemCount();
+        if (item_count[ufo_index] < ufo.capacity() and Util::IsIntersect(ufo, stage.office())) {
+            output.actions.add(Action::PickUp(ufo_index));
+            item_count[ufo_index] = ufo.capacity();
+        }
+        if (item_count[ufo_index] < ufo.capacity() and ufo.type() == UFOType_Small) {
+            repeat (large_ufo_index, Parameter::LargeUFOCount) {
+                if (Util::IsIntersect(ufo, stage.ufos()[large_ufo_index])) {
+                    output.actions.add(Action::Pass(large_ufo_index, ufo_index));
+                    int delta = min(item_count[large_ufo_index], ufo.capacity() - item_count[ufo_index]);
+                    item_count[ufo_index] += delta;
+                    item_count[large_ufo_index] -= delta;
+                }
+            }
+        }
+        while (item_count[ufo_index] and next[ufo_index] < int(seq.size()) and Util::IsIntersect(ufo, stage.houses()[seq[next[ufo_index]]])) {
+            output.actions.add(Action::Deliver(ufo_index, seq[next[ufo_index]]));
+            item_count[ufo_index] -= 1;
+            next[ufo_index] += 1;
+        }
+    }
+    repeat (ufo_index, Parameter::UFOCount) {
+        auto const & ufo = stage.ufos()[ufo_index];
+        auto const & seq = plan.sequence[ufo_index];
+        Vector2 pos = ufo.pos();
+        if (next[ufo_index] == int(seq.size())) {
+            // 配り終えたら待機
+        } else if (item_count[ufo_index] == 0) {
+            // 最寄りの補給場所へ
+            pos = stage.office().pos();
             if (ufo.type() == UFOType_Small) {
                 repeat (large_ufo_index, Parameter::LargeUFOCount) {
                     auto const & large_ufo = stage.ufos()[large_ufo_index];
-                    if (large_ufo.itemCount() >= 5) {
-                        if (ufo.pos().dist(large_ufo.pos()) < ufo.pos().dist(pos)) {
-                            pos = large_ufo.pos();  // NOTE: The prediction is required.
-                        }
+                    if (item_count[large_ufo_index] >= Parameter::SmallUFOCapacity and ufo.pos().squareDist(large_ufo.pos()) < ufo.pos().squareDist(pos)) {
+                        pos = large_ufo.pos();
                     }
                 }
             }
-            target_positions.add(pos);
-
         } else {
-            // 家へ向かう
-            int house_index = target.from_ufo(ufo_index);
-            if (house_index != TargetManager::NONE) {
-                target_positions.add(stage.houses()[house_index].pos());
+            // 次の家へ。その次の家があれば、触れられる範囲でそちらへ寄せる
+            pos = stage.houses()[seq[next[ufo_index]]].pos();
+            if (next[ufo_index] + 1 < int(seq.size()) and item_count[ufo_index] >= 2) {
+                Vector2 dir = stage.houses()[seq[next[ufo_index] + 1]].pos() - pos;
+                float reach = 0.9f * (ufo.radius() + Parameter::HouseRadius);
+                if (not dir.isZeroStrict()) pos += dir.unit(min(reach, dir.length()));
+            }
+        }
+        output.target_positions.add(pos);
+    }
+}
 
-            // 暇なら待機
+/// 計画をシミュレーションで実行します。limit ターン以内に終わらなければ空を返します。
+scratch_vector<turn_output_t> simulate_plan(Stage const & a_stage, sequence_plan_t const & plan, int limit) {
+    Stage stage = a_stage;
+    array<int, Parameter::UFOCount> next = {};
+    scratch_vector<turn_output_t> outputs;
+    outputs.reserve(limit);
+    HPC_STATS_ADD(rollouts, 1);
+    while (not stage.hasFinished()) {
+        if (stage.turn() >= limit) return scratch_vector<turn_output_t>();
+        turn_output_t output = {};
+        follow_plan(stage, plan, next, output);
+        stage.moveItems(output.actions);
+        stage.moveUFOs(output.target_positions);
+        stage.advanceTurn();
+        HPC_STATS_ADD(simulatedTurns, 1);
+        outputs.push_back(output);
+    }
+    return outputs;
+}
+
+/// 出力の列から、UFOごとの配達順序を取り出します。
+sequence_plan_t extract_plan(vector<turn_output_t> const & outputs) {
+    sequence_plan_t plan;
+    for (auto const & output : outputs) {
+        repeat (i, output.actions.count()) {
+            Action const & action = output.actions[i];
+            if (action.type() == ActionType_Deliver) plan.sequence[action.ufoIndex()].push_back(action.houseIndex());
+        }
+    }
+    return plan;
+}
+
+/// 配達順序を焼きなましで改善し、シミュレーションで確かめて、incumbent より短い出力の列を返します。なければ空を返します。
+///
+/// 近傍は、UFO内の 交換、移動、区間の反転 と、UFO間の 交換、移動 です。
+scratch_vector<turn_output_t> anneal_plan(Stage const & a_stage, travel_matrix_t const & travel, vector<turn_output_t> const & incumbent) {
+    sequence_plan_t plan = extract_plan(incumbent);
+    plan.reset(a_stage, travel);
+    // 列は作業用メモリから確保し、Answer::finalize まで解放されない。
+    // どの列も全ての家が入るだけ先に確保し、最良の計画へは書き写すだけにして、反復ごとにメモリを増やさない
+    for (auto & seq : plan.sequence) seq.reserve(a_stage.houses().count());
+    sequence_plan_t best = plan;
+    for (auto & seq : best.sequence) seq.reserve(a_stage.houses().count());
+    double current = plan.objective();
+    double best_objective = current;
+    bool best_is_validated = true;  // 元の計画は結果が分かっている
+    int limit = incumbent.size();
+    // 検証のたびに作業用メモリを巻き戻せるよう、先に確保しておく
+    scratch_vector<turn_output_t> found;
+    found.reserve(limit);
+    // 移動を適用した後に、壊した区間の費用を足し直すための範囲 (UFO, l, r) の組
+    struct range_t { int ufo_index, l, r; };
+    array<range_t, 4> ranges;
+    array<double, 4> before;
+    // 採用しなかった移動を戻すための記録。std::function だと毎回確保が起きるので、値で持つ
+    struct undo_t {
+        int kind, i, j, house_index;
+        void apply(scratch_vector<int> & su, scratch_vector<int> & sv) const {
+            switch (kind) {
+                case 0: swap(su[i], su[j]); break;
+                case 1: su.erase(su.begin() + j); su.insert(su.begin() + i, house_index); break;
+                case 2: reverse(su.begin() + i, su.begin() + j + 1); break;
+                case 3: swap(su[i], sv[j]); break;
+                case 4: sv.erase(sv.begin() + j); su.insert(su.begin() + i, house_index); break;
+            }
+        }
+    };
+    repeat (iteration, anneal_iteration) {
+        int u = uniform_int_distribution<int>(0, Parameter::UFOCount - 1)(gen);
+        int v = uniform_int_distribution<int>(0, Parameter::UFOCount - 1)(gen);
+        auto & su = plan.sequence[u];
+        auto & sv = plan.sequence[v];
+        if (su.empty()) continue;
+        int kind = uniform_int_distribution<int>(0, 4)(gen);
+        int i = uniform_int_distribution<int>(0, su.size() - 1)(gen);
+        int range_count = 0;
+        undo_t undo = { kind, i, -1, -1 };
+        if (kind <= 2) {  // UFO内
+            if (su.size() < 2) continue;
+            int j = uniform_int_distribution<int>(0, su.size() - 2)(gen);
+            if (j >= i) ++ j;
+            int l = min(i, j), r = max(i, j);
+            if (kind == 0) {  // 交換: 2か所の前後の区間だけが変わる
+                ranges[range_count ++] = { u, l, l + 2 };
+                ranges[range_count ++] = { u, max(l + 2, r), r + 2 };
+                if (r == l + 1) range_count = 1, ranges[0].r = r + 2;
+            } else {  // 移動と反転: 区間 [l, r] とその次だけが変わる
+                ranges[range_count ++] = { u, l, r + 2 };
+            }
+            repeat (k, range_count) before[k] = plan.range_cost(ranges[k].ufo_index, ranges[k].l, ranges[k].r);
+            if (kind == 0) {
+                swap(su[i], su[j]);
+                undo.j = j;
+            } else if (kind == 1) {
+                int house_index = su[i];
+                su.erase(su.begin() + i);
+                su.insert(su.begin() + j, house_index);
+                undo.j = j;
+                undo.house_index = house_index;
             } else {
-                target_positions.add(ufo.pos());
+                reverse(su.begin() + l, su.begin() + r + 1);
+                undo.i = l;
+                undo.j = r;
+            }
+        } else {  // UFO間
+            if (u == v) continue;
+            if (kind == 3) {  // 交換
+                if (sv.empty()) continue;
+                int j = uniform_int_distribution<int>(0, sv.size() - 1)(gen);
+                ranges[range_count ++] = { u, i, i + 2 };
+                ranges[range_count ++] = { v, j, j + 2 };
+                repeat (k, range_count) before[k] = plan.range_cost(ranges[k].ufo_index, ranges[k].l, ranges[k].r);
+                swap(su[i], sv[j]);
+                undo.j = j;
+            } else {  // 移動: 補給の区切りがずれるので、動かした位置から後ろが変わる
+                int j = uniform_int_distribution<int>(0, sv.size())(gen);
+                ranges[range_count ++] = { u, i, int(su.size()) };
+                ranges[range_count ++] = { v, j, int(sv.size()) + 1 };
+                repeat (k, range_count) before[k] = plan.range_cost(ranges[k].ufo_index, ranges[k].l, ranges[k].r);
+                int house_index = su[i];
+                su.erase(su.begin() + i);
+                sv.insert(sv.begin() + j, house_index);
+                undo.j = j;
+                undo.house_index = house_index;
+            }
+        }
+        auto saved_cost = plan.cost;
+        repeat (k, range_count) {
+            auto const & it = ranges[k];
+            plan.cost[it.ufo_index] += plan.range_cost(it.ufo_index, it.l, it.r) - before[k];
+        }
+        double next = plan.objective();
+        double temperature = anneal_initial_temperature * (1 - iteration / double(anneal_iteration));
+        if (next <= current or bernoulli_distribution(exp((current - next) / max(temperature, 1e-9)))(gen)) {
+            current = next;
+            if (current < best_objective - 1e-9) {
+                repeat (ufo_index, Parameter::UFOCount) best.sequence[ufo_index].assign(whole(plan.sequence[ufo_index]));
+                best.cost = plan.cost;
+                best_objective = current;
+                best_is_validated = false;
+            }
+        } else {
+            undo.apply(su, sv);
+            plan.cost = saved_cost;
+        }
+        // 区切りごとに最良の計画を実際に動かして確かめる
+        if ((iteration + 1) % (anneal_iteration / anneal_validation_count) == 0 and not best_is_validated) {
+            best_is_validated = true;
+            scratch_scope_t scope;
+            scratch_vector<turn_output_t> outputs = simulate_plan(a_stage, best, limit);
+            if (not outputs.empty() and int(outputs.size()) < limit) {
+                limit = int(outputs.size());
+                found.assign(whole(outputs));
             }
         }
     }
+    return found;
 }
 
-struct turn_output_t {
-    Actions actions;
-    TargetPositions target_positions;
+/// 計画の方式。PlanOnline では init でほとんど計算せず、毎ターン短い先読みで計画を直します。
+/// ステージ開始時にまとめて待つ代わりに、1ターンあたりの待ち時間が一定に収まります。
+/// search_mode と同じく、比較用の解答が切り替えます。
+enum plan_mode_t {
+    PlanPrecompute,
+    PlanOnline,
+};
+thread_local int plan_mode = PlanPrecompute;
+/// オンライン計画の先読みのターン数。
+const int online_horizon = 60;
+/// オンライン計画で1ターンにシミュレーションするターン数の予算。時間ではなくターン数で決めるので、結果は再現します。
+const int online_turn_budget = 200;
+
+/// オンライン計画の1ターン分。乱択の結果を持つので、同じ状態から同じ出力を再現できます。
+struct online_step_t {
+    pair<int, int> pin;             // 固定した小さいUFOと家。固定しなければ (-1, -1)
+    initial_house_t initial_house;  // 初手の小さいUFOの行き先
+    turn_output_t output;
 };
-vector<turn_output_t> result;
+
+/// 先読みの計画。steps の先頭が次に実行するターンで、leaf は最後のターンを実行した後の状態です。
+struct online_plan_t {
+    vector<online_step_t> steps;
+    rollout_state_t leaf;
+    explicit online_plan_t(Stage const & stage) : leaf(stage) { steps.reserve(online_horizon + 1); }
+    /// 終わった計画は早く終わるほど良く、終わっていなければビームサーチと同じ評価値で比べます。
+    double score() const {
+        return leaf.stage.hasFinished() ? 1e9 - leaf.stage.turn() : evaluate_state(leaf);
+    }
+};
+
+/// 受け取ったステージに合わせて毎ターン計画を直す、receding horizon の制御器です。
+///
+/// 前のターンの計画を1ターン延ばして最良の候補とし、実際の状態から予算の分だけ乱択したロールアウトを先読みの深さまで進めて、
+/// 良いものがあれば置き換えます。計画の終わりが見えていれば、ランダムな再試行と同じ下界で打ち切ります。
+/// 計画の先頭を実行するときは、記録した乱択を根の状態に適用し直して、解答の内部状態を実際のステージと揃えます。
+struct online_planner_t {
+    travel_matrix_t travel;
+    scratch_vector<town_t> towns;
+    area_mask_t area_mask;
+    rollout_state_t root;       // 実際のステージに対応する状態
+    online_plan_t plan;
+    online_plan_t candidate;
+    bool has_plan;
+    turn_output_t current;      // このターンの出力
+    double latency_sum;         // 1ターンの判断に掛かった時間 (秒)
+    double latency_max;
+    int decision_count;
+
+    online_planner_t(Stage const & stage, travel_matrix_t const & a_travel, scratch_vector<town_t> const & a_towns, area_mask_t const & a_area_mask)
+        : travel(a_travel), towns(a_towns), area_mask(a_area_mask), root(stage), plan(stage), candidate(stage),
+          has_plan(false), latency_sum(0), latency_max(0), decision_count(0) {}
+
+    /// このターンの出力を決めて、根を1ターン進めます。
+    void decide(Stage const & stage) {
+        thread_timer_t timer;
+        timer.start();
 #ifdef LOCAL
-int current_stage = -1;
+        assert (root.stage.turn() == stage.turn());
+#endif
+        if (has_plan) extend(plan);
+        replan();
+        if (not has_plan) {
+            // 候補がすべて打ち切られたときは、根から乱択せずに1ターン延ばす
+            plan.leaf = root;
+            plan.steps.clear();
+            extend(plan);
+            has_plan = true;
+        }
+#ifdef LOCAL
+        assert (not plan.steps.empty());
+#endif
+        online_step_t step = plan.steps.front();
+        plan.steps.erase(plan.steps.begin());
+        if (step.pin.first != -1) pin_house(root, step.pin.first, step.pin.second);
+        current = {};
+        advance(root, current, travel, towns, area_mask, step.initial_house);
+        double elapsed = timer.elapsed_sec();
+        latency_sum += elapsed;
+        setmax(latency_max, elapsed);
+        decision_count += 1;
+    }
+
+    /// 計画を乱択せずに1ターン延ばします。
+    void extend(online_plan_t & it) {
+        if (it.leaf.stage.hasFinished()) return;
+        online_step_t step = { make_pair(-1, -1), {}, {} };
+        fill(whole(step.initial_house), -1);
+        advance(it.leaf, step.output, travel, towns, area_mask, step.initial_house);
+        it.steps.push_back(step);
+    }
+
+    /// 根から候補を作り、計画より良ければ置き換えます。
+    void replan() {
+        int limit = root.stage.turn() + online_horizon;
+        for (int simulated = 0; simulated < online_turn_budget; ) {
+            scratch_scope_t scope;
+            HPC_STATS_ADD(rollouts, 1);
+            candidate.steps.clear();
+            candidate.leaf = root;
+            rollout_state_t & state = candidate.leaf;
+            int finish = has_plan and plan.leaf.stage.hasFinished() ? plan.leaf.stage.turn() : Parameter::GameTurnLimit + 1;
+            bool pruned = false;
+            int next_check = 0;
+            while (not state.stage.hasFinished() and state.stage.turn() < limit) {
+                // 計画より早く終われないなら打ち切る
+                if (state.stage.turn() >= next_check) {
+                    int slack = finish - state.stage.turn() - remaining_turns_lower_bound(state.stage);
+                    if (slack <= 0) {
+                        HPC_STATS_ADD(prunedRollouts, 1);
+                        pruned = true;
+                        break;
+                    }
+                    next_check = state.stage.turn() + (slack + 1) / 2;
+                }
+                online_step_t step;
+                step.pin = perturb_state(state, area_mask, towns.size());
+                fill(whole(step.initial_house), -1);
+                step.output = {};
+                advance(state, step.output, travel, towns, area_mask, step.initial_house);
+                candidate.steps.push_back(step);
+            }
+            // すぐに打ち切った候補も1ターン分と数えて、予算を必ず使い切るようにする
+            simulated += max<int>(1, candidate.steps.size());
+            if (not pruned and (not has_plan or candidate.score() > plan.score())) {
+                swap(plan, candidate);
+                has_plan = true;
+            }
+        }
+    }
+};
+thread_local unique_ptr<online_planner_t> online;
+
+thread_local vector<turn_output_t> result;
+#ifdef LOCAL
+/// ステージのターン数を出力するときの色。
+char const * turn_color(int turn) {
+    return
+        turn <= 50 ? "\x1b[32m" :
+        turn <= 70 ? "\x1b[32;1m" :
+        turn < 100 ? "\x1b[33;1m" :
+        turn < 130 ? "\x1b[33m" :
+        turn < 150 ? "\x1b[31;1m" :
+        "\x1b[31m";
+}
 #endif
 
 }
@@ -487,95 +2074,97 @@ void Answer::init(Stage const & a_stage) {
     using namespace Solver;
 
     result.clear();
-    vector<town_t> towns = detect_towns(a_stage.houses());
-#ifdef LOCAL
-    current_stage += 1;
-#endif
+    gen = minstd_rand();
+    scratch_vector<town_t> towns = detect_towns(a_stage.houses());
 
-    towns = reconstruct_towns_from_centers(get_town_centers(towns), StageParameter::TownRadius * 1.2, a_stage.houses());
-    vector<int> countryside_house_indices = get_countryside_house_indices(a_stage.houses().count(), towns);
-    towns = reconstruct_towns_from_centers(get_town_centers(towns), StageParameter::TownRadius * 2, a_stage.houses());
+    towns = reconstruct_towns_from_centers(get_town_centers(towns), StageParameter::TownRadius * params.countryside_radius_scale, a_stage.houses());
+    HouseSet countryside_houses = get_countryside_houses(a_stage.houses().count(), towns);
+    towns = reconstruct_towns_from_centers(get_town_centers(towns), StageParameter::TownRadius * params.town_radius_scale, a_stage.houses());
+    travel_matrix_t travel;
+    travel.reset(a_stage.houses());
+    if (plan_mode == PlanOnline) {
+        // 準備だけして、計画は毎ターン立てる。街の組合せは最初のものだけ使う
+        rotate(towns.begin(), towns.begin() + 1, towns.end());
+        area_mask_t area_mask = make_area_mask(towns, countryside_houses);
+        online.reset(new online_planner_t(a_stage, travel, towns, area_mask));
+        return;
+    }
     repeat (combination, towns.size() == 2 ? 1 : 3) {
         rotate(towns.begin(), towns.begin() + 1, towns.end());
-        repeat (iteration, 200) {
-            Stage stage = a_stage;
-            TargetManager target = {};
-
-            vector<turn_output_t> outputs;
-            int current_best = -1;
-            vector<int> best_initial(Parameter::UFOCount, -1);
-            while (not stage.hasFinished() and stage.turn() < Parameter::GameTurnLimit) {
-                turn_output_t output = {};
-                vector<int> initial_house = best_initial;
-                for (int modified = uniform_int_distribution<int>(2, 3)(gen); modified --; ) {
-                    initial_house[uniform_int_distribution<int>(Parameter::LargeUFOCount, Parameter::UFOCount - 1)(gen)] = -1;
-                }
-                move_items_with_towns(stage, output.actions, target, towns, countryside_house_indices, initial_house);
-                stage.moveItems(output.actions);
-                move_ufos_with_towns(stage, output.target_positions, target, towns);
-                stage.moveUFOs(output.target_positions);
-                stage.advanceTurn();
-                outputs.push_back(output);
-
-#ifdef DEBUG
-        // debug
-cerr << "turn " << stage.turn() << ": ";
-repeat (house_index, stage.houses().count()) cerr << stage.houses()[house_index].delivered();
-cerr << " / ";
-repeat (ufo_index, Parameter::UFOCount) cerr << target.from_ufo(ufo_index) << "(" << stage.ufos()[ufo_index].itemCount() << ") ";
-cerr << endl;
-#endif
-
-#ifdef LOCAL
-                // check invariant
-                repeat (ufo_index, Parameter::UFOCount) {
-                    int house_index = target.from_ufo(ufo_index);
-                    if (house_index == TargetManager::NONE) {
-                        // nop
-                    } else if (house_index == TargetManager::DELIVERED) {
-                        assert (false);
-                    } else {
-                        assert (target.from_house(house_index) == ufo_index);
+        area_mask_t area_mask = make_area_mask(towns, countryside_houses);
+        if (search_mode & SearchRestart) {
+            int simulated = 0;
+            for (int iteration = 0; iteration == 0 or simulated < params.restart_turn_budget_per_turn * int(result.size()); ++ iteration) {
+                // ロールアウトの作業用メモリは1回ごとに巻き戻す
+                scratch_scope_t scope;
+                rollout_state_t state(a_stage);
+                HPC_STATS_ADD(rollouts, 1);
+                scratch_vector<turn_output_t> outputs;
+                int current_best = -1;
+                initial_house_t best_initial;
+                fill(whole(best_initial), -1);
+                bool pruned = false;
+                int next_check = 0;
+                while (not state.stage.hasFinished() and state.stage.turn() < Parameter::GameTurnLimit) {
+                    // 今の最良より短く終われないなら打ち切る
+                    if (not result.empty() and int(outputs.size()) >= next_check) {
+                        int slack = int(result.size()) - int(outputs.size()) - remaining_turns_lower_bound(state.stage);
+                        if (slack <= 0) {
+                            HPC_STATS_ADD(prunedRollouts, 1);
+                            pruned = true;
+                            break;
+                        }
+                        // 経過ターン数と下界の和は1ターンにほぼ2までしか増えないので、余裕の半分は調べずに進める
+                        next_check = outputs.size() + (slack + 1) / 2;
                     }
-                }
-                repeat (house_index, stage.houses().count()) {
-                    int ufo_index = target.from_house(house_index);
-                    if (ufo_index == TargetManager::NONE) {
-                        // nop
-                    } else if (ufo_index == TargetManager::DELIVERED) {
-                        assert (stage.houses()[house_index].delivered());
-                    } else {
-                        assert (target.from_ufo(ufo_index) == house_index);
+                    auto mutate_initial_house = [&]() {
+                        initial_house_t initial_house = best_initial;
+                        for (int modified = uniform_int_distribution<int>(params.min_modified, max(params.min_modified, params.max_modified))(gen); modified --; ) {
+                            initial_house[uniform_int_distribution<int>(Parameter::LargeUFOCount, Parameter::UFOCount - 1)(gen)] = -1;
+                        }
+                        return initial_house;
+                    };
+                    // 受け渡しの起きないターンはまとめて進める。次の下界の確認は越えない
+                    int limit = Parameter::GameTurnLimit - state.stage.turn();
+                    if (not result.empty()) setmin(limit, next_check - int(outputs.size()));
+                    int quiet = count_quiet_turns(state, limit);
+                    if (quiet) {
+                        advance_quiet(state, outputs, quiet, towns);
+                        // 乱数は1ターンずつ進めた場合と同じだけ消費する
+                        repeat (turn, quiet) mutate_initial_house();
+                        continue;
+                    }
+                    turn_output_t output = {};
+                    initial_house_t initial_house = mutate_initial_house();
+                    advance(state, output, travel, towns, area_mask, initial_house);
+                    outputs.push_back(output);
+                    if (current_best == -1 or int(outputs.size()) <= current_best) {
+                        current_best = int(outputs.size());
+                        best_initial = initial_house;
                     }
                 }
-#endif
-                if (current_best == -1 or outputs.size() <= current_best) {
-                    current_best = outputs.size();
-                    best_initial = initial_house;
+                simulated += outputs.size();
+
+                if (not pruned and (result.empty() or outputs.size() < result.size())) {
+                    result.assign(whole(outputs));
                 }
             }
-
-            if (result.empty() or outputs.size() < result.size()) {
+        }
+        if (search_mode & SearchBeam) {
+            int incumbent = result.empty() ? Parameter::GameTurnLimit : result.size();
+            vector<turn_output_t> outputs = beam_search(a_stage, travel, towns, area_mask, incumbent);
+            if (not outputs.empty() and (result.empty() or outputs.size() < result.size())) {
                 result = outputs;
             }
         }
     }
+    if (use_anneal and not result.empty()) {
+        scratch_vector<turn_output_t> outputs = anneal_plan(a_stage, travel, result);
+        if (not outputs.empty()) result.assign(whole(outputs));
+    }
 
 #ifdef LOCAL
-    const char *green = "\x1b[32m";
-    const char *bright_green = "\x1b[32;1m";
-    const char *bright_yellow = "\x1b[33;1m";
-    const char *yellow = "\x1b[33m";
-    const char *bright_red = "\x1b[31;1m";
-    const char *red = "\x1b[31m";
-    const char *color =
-        int(result.size()) <= 50 ? green :
-        int(result.size()) <= 70 ? bright_green :
-        int(result.size()) < 100 ? bright_yellow :
-        int(result.size()) < 130 ? yellow :
-        int(result.size()) < 150 ? bright_red :
-        red;
-    fprintf(stderr, "%5d |%s%5d\x1b[0m\n", current_stage, color, int(result.size()));
+    fprintf(stderr, "%5d |%s%5d\x1b[0m\n", StageContext::Index(), turn_color(result.size()), int(result.size()));
 #endif
 }
 
@@ -594,6 +2183,11 @@ cerr << endl;
 /// @param[out] actions この受け渡しフェーズの行動を指定する配列。
 void Answer::moveItems(Stage const & stage, Actions & actions) {
     using namespace Solver;
+    if (plan_mode == PlanOnline) {
+        online->decide(stage);
+        actions = online->current.actions;
+        return;
+    }
     actions = result[stage.turn()].actions;
 }
 
@@ -610,6 +2204,10 @@ void Answer::moveItems(Stage const & stage, Actions & actions) {
 /// @param[out] target_positions 各UFOの目標座標を指定する配列。
 void Answer::moveUFOs(Stage const & stage, TargetPositions & target_positions) {
     using namespace Solver;
+    if (plan_mode == PlanOnline) {
+        target_positions = online->current.target_positions;
+        return;
+    }
     target_positions = result[stage.turn()].target_positions;
 }
 
@@ -620,7 +2218,84 @@ void Answer::moveUFOs(Stage const & stage, TargetPositions & target_positions) {
 ///
 /// @param[in] stage 現在のステージ。
 void Answer::finalize(Stage const & stage) {
+    using namespace Solver;
+    if (plan_mode == PlanOnline) {
+#ifdef LOCAL
+        // オンライン計画ではターン数が終わるまで分からないので、ここで1ターンの判断の待ち時間と一緒に出力する
+        fprintf(stderr, "%5d |%s%5d\x1b[0m | latency mean %.3f ms, max %.3f ms\n", StageContext::Index(), turn_color(stage.turn()), stage.turn(),
+                1000 * online->latency_sum / max(1, online->decision_count), 1000 * online->latency_max);
+#endif
+        online.reset();
+    }
+    // このステージの作業用メモリをまとめて解放する
+    scratch_arena.reset();
+}
+
+#ifdef LOCAL
+namespace Solver {
+
+/// 探索の設定を init の間だけ切り替えた解答。-a で提出する解答と比べるために使います。
+template <int SearchMode, bool UseAnneal, int PlanMode = PlanPrecompute>
+struct configured_answer_t {
+    Answer answer;
+    void init(Stage const & stage) {
+        int saved_search_mode = search_mode;
+        bool saved_use_anneal = use_anneal;
+        search_mode = SearchMode;
+        use_anneal = UseAnneal;
+        with_plan_mode([&]() { answer.init(stage); });
+        search_mode = saved_search_mode;
+        use_anneal = saved_use_anneal;
+    }
+    void moveItems(Stage const & stage, Actions & actions) { with_plan_mode([&]() { answer.moveItems(stage, actions); }); }
+    void moveUFOs(Stage const & stage, TargetPositions & target_positions) { with_plan_mode([&]() { answer.moveUFOs(stage, target_positions); }); }
+    void finalize(Stage const & stage) { with_plan_mode([&]() { answer.finalize(stage); }); }
+    /// 計画の方式は毎ターンの呼び出しでも使うので、全ての呼び出しで切り替えます。
+    template <class F>
+    static void with_plan_mode(F f) {
+        int saved_plan_mode = plan_mode;
+        plan_mode = PlanMode;
+        f();
+        plan_mode = saved_plan_mode;
+    }
+};
+using no_anneal_answer_t = configured_answer_t<SearchRestart, false>;
+using restart_beam_answer_t = configured_answer_t<SearchRestart | SearchBeam, true>;
+using online_answer_t = configured_answer_t<SearchRestart, false, PlanOnline>;
+
 }
 
+HPC_REGISTER_ANSWER("no-anneal", Solver::no_anneal_answer_t);
+HPC_REGISTER_ANSWER("restart-beam", Solver::restart_beam_answer_t);
+HPC_REGISTER_ANSWER("online", Solver::online_answer_t);
+
+// -tune で調整する定数。範囲は探索に使うもので、値を制限するものではありません。
+HPC_REGISTER_TUNABLE("restart_turn_budget_per_turn", Solver::solver_params_t().restart_turn_budget_per_turn, 25, 400, true,
+    [](double value) { Solver::params.restart_turn_budget_per_turn = int(value); });
+HPC_REGISTER_TUNABLE("countryside_radius_scale", Solver::solver_params_t().countryside_radius_scale, 0.8, 2, false,
+    [](double value) { Solver::params.countryside_radius_scale = value; });
+HPC_REGISTER_TUNABLE("town_radius_scale", Solver::solver_params_t().town_radius_scale, 1.2, 3, false,
+    [](double value) { Solver::params.town_radius_scale = value; });
+HPC_REGISTER_TUNABLE("large_penalty_radius", Solver::solver_params_t().large_penalty_radius, 0, 200, false,
+    [](double value) { Solver::params.large_penalty_radius = value; });
+HPC_REGISTER_TUNABLE("min_modified", Solver::solver_params_t().min_modified, 1, 4, true,
+    [](double value) { Solver::params.min_modified = int(value); });
+HPC_REGISTER_TUNABLE("max_modified", Solver::solver_params_t().max_modified, 1, 6, true,
+    [](double value) { Solver::params.max_modified = int(value); });
+HPC_REGISTER_TUNABLE("refill_aim", Solver::solver_params_t().refill_aim, 0, 1, true,
+    [](double value) { Solver::params.refill_aim = value != 0; });
+// 同伴の表は、街の数ごとに同じ人数の街をまとめて1つの定数にする
+HPC_REGISTER_TUNABLE("split1", Solver::solver_params_t().team_split[0][0], 0, 8, true,
+    [](double value) { Solver::params.team_split[0][0] = int(value); });
+HPC_REGISTER_TUNABLE("split2", Solver::solver_params_t().team_split[1][0], 0, 4, true,
+    [](double value) { Solver::params.team_split[1][0] = Solver::params.team_split[1][1] = int(value); });
+HPC_REGISTER_TUNABLE("split3_pair", Solver::solver_params_t().team_split[2][0], 0, 2, true,
+    [](double value) { Solver::params.team_split[2][0] = Solver::params.team_split[2][1] = int(value); });
+HPC_REGISTER_TUNABLE("split3_last", Solver::solver_params_t().team_split[2][2], 0, 6, true,
+    [](double value) { Solver::params.team_split[2][2] = int(value); });
+HPC_REGISTER_TUNABLE("split45", Solver::solver_params_t().team_split[3][0], 0, 3, true,
+    [](double value) { Solver::params.team_split[3][0] = Solver::params.team_split[3][1] = Solver::params.team_split[4][0] = Solver::params.team_split[4][1] = int(value); });
+#endif
+
 } // namespace
 // EOF
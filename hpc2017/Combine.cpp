@@ -17,19 +17,33 @@
 
 // Answer.cpp以外のファイルをインクルードします。
 // 順番は任意です。
+// (Bench.cpp はベンチマーク用のエントリポイントなので、CombineBench.cpp でインクルードします)
 #include "src/Action.cpp"
+#include "src/AllocTracker.cpp"
+#include "src/AnswerRegistry.cpp"
 #include "src/Game.cpp"
 #include "src/House.cpp"
+#include "src/LowerBound.cpp"
 #include "src/Main.cpp"
 #include "src/Math.cpp"
+#include "src/NullRecorder.cpp"
 #include "src/Office.cpp"
 #include "src/Parameter.cpp"
+#include "src/PlanFile.cpp"
 #include "src/Random.cpp"
 #include "src/RandomSeed.cpp"
 #include "src/Recorder.cpp"
+#include "src/ResultPipeline.cpp"
 #include "src/Simulator.cpp"
 #include "src/Stage.cpp"
+#include "src/StageContext.cpp"
+#include "src/StageCorpus.cpp"
+#include "src/Stats.cpp"
+#include "src/StreamingRecorder.cpp"
 #include "src/Timer.cpp"
+#include "src/Tournament.cpp"
+#include "src/Tunable.cpp"
+#include "src/Tuner.cpp"
 #include "src/UFO.cpp"
 #include "src/Util.cpp"
 #include "src/Vector2.cpp"
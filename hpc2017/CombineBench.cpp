@@ -0,0 +1,54 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+// ベンチマーク用に、複数のcppファイルを1ファイルにまとめてコンパイルします。
+// Combine.cpp と同じ構成で、Main.cpp の代わりに Bench.cpp をエントリポイントにします。
+
+// この手法は、あるcppの記述が別のcppに影響を与えるケースがあることに注意してください。
+// 例: #includeしたヘッダが他のcppでも使用できる
+// 例: #defineで定数やマクロを定義すると、他のcppにも反映される
+// 例: 無名名前空間で関数を定義すると、他のcppからも参照できる
+
+// Answer.cpp以外のファイルをインクルードします。
+// 順番は任意です。
+#include "src/Action.cpp"
+#include "src/AllocTracker.cpp"
+#include "src/AnswerRegistry.cpp"
+#include "src/Game.cpp"
+#include "src/House.cpp"
+#include "src/LowerBound.cpp"
+#include "src/Math.cpp"
+#include "src/NullRecorder.cpp"
+#include "src/Office.cpp"
+#include "src/Parameter.cpp"
+#include "src/PlanFile.cpp"
+#include "src/Random.cpp"
+#include "src/RandomSeed.cpp"
+#include "src/Recorder.cpp"
+#include "src/ResultPipeline.cpp"
+#include "src/Simulator.cpp"
+#include "src/Stage.cpp"
+#include "src/StageContext.cpp"
+#include "src/StageCorpus.cpp"
+#include "src/Stats.cpp"
+#include "src/StreamingRecorder.cpp"
+#include "src/Timer.cpp"
+#include "src/Tournament.cpp"
+#include "src/Tunable.cpp"
+#include "src/Tuner.cpp"
+#include "src/UFO.cpp"
+#include "src/Util.cpp"
+#include "src/Vector2.cpp"
+
+// Answer.cppは最後にインクルードします。
+// (Answer.cpp内の定義が、意図せず他のファイルに影響を与えるのを防ぐため)
+#include "src/Answer.cpp"
+
+// ベンチマークは解答の関数も計測するので、Answer.cpp の後にインクルードします。
+#include "src/Bench.cpp"
@@ -0,0 +1,211 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "AllocTracker.hpp"
+
+#include <cstdlib>
+#include <new>
+#include "Print.hpp"
+
+namespace hpc {
+
+namespace {
+
+//------------------------------------------------------------------------------
+/// operator new から触る記録。
+///
+/// スレッドの終了時や静的初期化の前にも触るので、生成・破棄の処理を持たない型にしています。
+struct AllocState
+{
+    AllocCounters total;    ///< 区分ごとの合計
+    long long freeCount;    ///< operator delete の呼び出し回数
+    AllocPhase phase;       ///< 現在の区分
+    bool isPaused;          ///< 記録器自身の確保を数えないための印
+};
+thread_local AllocState tState;
+
+/// 区分の名前。
+const char* const PhaseNames[AllocPhase_TERM] = {
+    "other", "generation", "init", "turn", "finalize", "recorder",
+};
+
+//------------------------------------------------------------------------------
+/// 全区分の合計を求めます。
+long long Sum(const long long (&aValues)[AllocPhase_TERM])
+{
+    long long sum = 0;
+    for (int i = 0; i < AllocPhase_TERM; ++i) {
+        sum += aValues[i];
+    }
+    return sum;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/// インスタンスを取得します。
+///
+/// スレッドごとに別のインスタンスです。
+AllocTracker& AllocTracker::Instance()
+{
+    static thread_local AllocTracker tracker;
+    return tracker;
+}
+
+//------------------------------------------------------------------------------
+/// 記録が有効なビルドかを取得します。
+bool AllocTracker::IsEnabled()
+{
+#ifdef HPC_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/// operator new から呼び出されます。
+void AllocTracker::OnAllocate(unsigned long long aSize)
+{
+    if (tState.isPaused) {
+        return;
+    }
+    tState.total.count[tState.phase] += 1;
+    tState.total.bytes[tState.phase] += aSize;
+}
+
+//------------------------------------------------------------------------------
+/// operator delete から呼び出されます。
+void AllocTracker::OnDeallocate()
+{
+    if (!tState.isPaused) {
+        tState.freeCount += 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+/// 以降の確保を数える区分を変更します。
+void AllocTracker::ChangePhase(AllocPhase aPhase)
+{
+    tState.phase = aPhase;
+}
+
+//------------------------------------------------------------------------------
+/// AllocTracker クラスのインスタンスを生成します。
+AllocTracker::AllocTracker()
+: mStageBegin()
+, mStages()
+{
+}
+
+//------------------------------------------------------------------------------
+/// ステージの記録を開始します。
+///
+/// endStage() までの確保を、そのステージの分として記録します。
+void AllocTracker::beginStage()
+{
+    mStageBegin = tState.total;
+}
+
+//------------------------------------------------------------------------------
+/// ステージの記録を終了します。
+void AllocTracker::endStage()
+{
+    AllocCounters stage = tState.total;
+    for (int i = 0; i < AllocPhase_TERM; ++i) {
+        stage.count[i] -= mStageBegin.count[i];
+        stage.bytes[i] -= mStageBegin.bytes[i];
+    }
+    tState.isPaused = true;
+    mStages.push_back(stage);
+    tState.isPaused = false;
+}
+
+//------------------------------------------------------------------------------
+/// 記録を出力します。
+///
+/// ステージごとの回数と、区分ごとの合計を出力します。
+/// ステージの外での確保 (起動時など) は合計にだけ含まれます。
+///
+/// @param[in] aIsSilent ステージごとの行を出力しないか。
+void AllocTracker::print(bool aIsSilent)const
+{
+    if (!IsEnabled()) {
+        HPC_PRINTF("Allocations: disabled. Build with ALLOC=1 to record them.\n");
+        return;
+    }
+
+    HPC_PRINTF("[allocations]\n");
+    if (!aIsSilent) {
+        HPC_PRINTF("stage");
+        for (int i = 0; i < AllocPhase_TERM; ++i) {
+            HPC_PRINTF(" | %10s", PhaseNames[i]);
+        }
+        HPC_PRINTF(" |        bytes\n");
+        for (int stage = 0; stage < int(mStages.size()); ++stage) {
+            HPC_PRINTF("% 5d", stage);
+            for (int i = 0; i < AllocPhase_TERM; ++i) {
+                HPC_PRINTF(" | %10lld", mStages[stage].count[i]);
+            }
+            HPC_PRINTF(" | %12lld\n", Sum(mStages[stage].bytes));
+        }
+    }
+
+    const double stages = mStages.empty() ? 1.0 : double(mStages.size());
+    HPC_PRINTF("phase      |       allocs |          bytes | allocs/stage\n");
+    for (int i = 0; i < AllocPhase_TERM; ++i) {
+        long long stageCount = 0;
+        for (const auto& stage : mStages) {
+            stageCount += stage.count[i];
+        }
+        HPC_PRINTF("%-10s | %12lld | %14lld | %12.2f\n",
+            PhaseNames[i], tState.total.count[i], tState.total.bytes[i], stageCount / stages);
+    }
+    HPC_PRINTF("%-10s | %12lld | %14lld |\n", "total", Sum(tState.total.count), Sum(tState.total.bytes));
+    HPC_PRINTF("Frees: %lld\n", tState.freeCount);
+}
+
+} // namespace
+
+#ifdef HPC_ALLOC_TRACKING
+//------------------------------------------------------------------------------
+// グローバルな operator new / delete を置き換えて、確保を数えます。
+// 例外は使えないので、確保に失敗したら終了します。
+
+void* operator new(std::size_t aSize)
+{
+    hpc::AllocTracker::OnAllocate(aSize);
+    void* ptr = std::malloc(aSize != 0 ? aSize : 1);
+    if (ptr == nullptr) {
+        std::abort();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t aSize)
+{
+    return ::operator new(aSize);
+}
+
+void operator delete(void* aPtr) noexcept
+{
+    if (aPtr != nullptr) {
+        hpc::AllocTracker::OnDeallocate();
+        std::free(aPtr);
+    }
+}
+
+void operator delete[](void* aPtr) noexcept
+{
+    ::operator delete(aPtr);
+}
+#endif
+
+// EOF
@@ -0,0 +1,84 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// ヒープ確保を数える区分。
+enum AllocPhase
+{
+    AllocPhase_Other,           ///< 以下以外。ゲームの進行やプランの書き出しなど
+    AllocPhase_StageGeneration, ///< ステージの生成・コーパスからの読み込み
+    AllocPhase_AnswerInit,      ///< Answer::init()
+    AllocPhase_AnswerTurn,      ///< Answer::moveItems(), Answer::moveUFOs()
+    AllocPhase_AnswerFinalize,  ///< Answer::finalize()
+    AllocPhase_Recorder,        ///< ログ記録器
+
+    AllocPhase_TERM,
+};
+
+//------------------------------------------------------------------------------
+/// 区分ごとのヒープ確保の回数とバイト数。
+struct AllocCounters
+{
+    long long count[AllocPhase_TERM];   ///< operator new の呼び出し回数
+    long long bytes[AllocPhase_TERM];   ///< 確保したバイト数の合計
+};
+
+//------------------------------------------------------------------------------
+/// ヒープ確保の記録。
+///
+/// HPC_ALLOC_TRACKING を定義してビルドしたときだけ、グローバルな operator new / delete を置き換えて、
+/// 現在の区分ごとに確保の回数とバイト数を数えます。
+/// 定義していなければ区分を切り替えるマクロは何も展開せず、operator new も置き換えません。
+/// 記録はスレッドごとなので、並列実行とは併用できません。
+class AllocTracker
+{
+public:
+    static AllocTracker& Instance();    ///< スレッドごとのインスタンスを取得します。
+    static bool IsEnabled();            ///< 記録が有効なビルドかを取得します。
+    static void OnAllocate(unsigned long long aSize); ///< operator new から呼び出されます。
+    static void OnDeallocate();         ///< operator delete から呼び出されます。
+    static void ChangePhase(AllocPhase aPhase); ///< 以降の確保を数える区分を変更します。
+
+    void beginStage();                  ///< ステージの記録を開始します。
+    void endStage();                    ///< ステージの記録を終了します。
+    void print(bool aIsSilent)const;    ///< 記録を出力します。
+
+private:
+    AllocTracker();
+
+    AllocCounters mStageBegin;          ///< ステージ開始時の合計
+    std::vector<AllocCounters> mStages; ///< ステージごとの確保
+};
+
+} // namespace
+
+#ifdef HPC_ALLOC_TRACKING
+/// 以降の確保を数える区分を変更します。
+#define HPC_ALLOC_SET_PHASE(aPhase) \
+    do { ::hpc::AllocTracker::ChangePhase(::hpc::AllocPhase_ ## aPhase); } while(false)
+/// ステージの記録を開始します。
+#define HPC_ALLOC_BEGIN_STAGE() \
+    do { ::hpc::AllocTracker::Instance().beginStage(); } while(false)
+/// ステージの記録を終了します。
+#define HPC_ALLOC_END_STAGE() \
+    do { ::hpc::AllocTracker::Instance().endStage(); } while(false)
+#else
+#define HPC_ALLOC_SET_PHASE(aPhase) do {} while(false)
+#define HPC_ALLOC_BEGIN_STAGE() do {} while(false)
+#define HPC_ALLOC_END_STAGE() do {} while(false)
+#endif
+
+// EOF
@@ -0,0 +1,81 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "AnswerRegistry.hpp"
+
+#include <cstring>
+#include "Answer.hpp"
+#include "Assert.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// インスタンスを取得します。
+AnswerRegistry& AnswerRegistry::Instance()
+{
+    static AnswerRegistry registry;
+    return registry;
+}
+
+//------------------------------------------------------------------------------
+/// AnswerRegistry クラスのインスタンスを生成します。
+AnswerRegistry::AnswerRegistry()
+: mEntries()
+{
+}
+
+//------------------------------------------------------------------------------
+/// 解答を登録します。
+///
+/// @param[in] aName 登録名。他の解答と重ならない、',' を含まない名前にしてください。
+/// @param[in] aCreate new で解答を生成する関数。
+/// @return 常に true を返します。(静的初期化で登録するための戻り値です)
+bool AnswerRegistry::add(const char* aName, AnswerVariant* (*aCreate)())
+{
+    HPC_ASSERT(aName != nullptr && std::strchr(aName, ',') == nullptr);
+    HPC_ASSERT(find(aName) == nullptr);
+    AnswerEntry entry = { aName, aCreate };
+    mEntries.push_back(entry);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// 名前から解答を探します。
+const AnswerEntry* AnswerRegistry::find(const char* aName)const
+{
+    for (const auto& entry : mEntries) {
+        if (!std::strcmp(entry.name, aName)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+/// 登録された解答の数を取得します。
+int AnswerRegistry::count()const
+{
+    return int(mEntries.size());
+}
+
+//------------------------------------------------------------------------------
+/// 登録された解答を取得します。
+const AnswerEntry& AnswerRegistry::entry(int aIndex)const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, count());
+    return mEntries[aIndex];
+}
+
+} // namespace
+
+// 提出する解答
+HPC_REGISTER_ANSWER("answer", hpc::Answer);
+
+// EOF
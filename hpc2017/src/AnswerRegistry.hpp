@@ -0,0 +1,88 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include "Stage.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// 比較のために名前を付けて登録する解答。
+///
+/// Answer と同じ関数を持つクラスを AnswerVariantOf で包んで使います。
+class AnswerVariant
+{
+public:
+    virtual ~AnswerVariant() {}
+    virtual void init(const Stage& aStage) = 0;                                             ///< 各ステージ開始時に呼び出されます。
+    virtual void moveItems(const Stage& aStage, Actions& aActions) = 0;                     ///< 受け渡しフェーズの行動を指定します。
+    virtual void moveUFOs(const Stage& aStage, TargetPositions& aTargetPositions) = 0;      ///< 移動フェーズの行動を指定します。
+    virtual void finalize(const Stage& aStage) = 0;                                         ///< 各ステージ終了時に呼び出されます。
+};
+
+//------------------------------------------------------------------------------
+/// Answer と同じ関数を持つクラス TAnswer を AnswerVariant として使うためのアダプタ。
+template <class TAnswer>
+class AnswerVariantOf : public AnswerVariant
+{
+public:
+    static AnswerVariant* Create() { return new AnswerVariantOf(); }
+
+    virtual void init(const Stage& aStage) { mAnswer.init(aStage); }
+    virtual void moveItems(const Stage& aStage, Actions& aActions) { mAnswer.moveItems(aStage, aActions); }
+    virtual void moveUFOs(const Stage& aStage, TargetPositions& aTargetPositions) { mAnswer.moveUFOs(aStage, aTargetPositions); }
+    virtual void finalize(const Stage& aStage) { mAnswer.finalize(aStage); }
+
+private:
+    TAnswer mAnswer;
+};
+
+//------------------------------------------------------------------------------
+/// 登録された解答。
+struct AnswerEntry
+{
+    const char* name;               ///< 登録名
+    AnswerVariant* (*create)();     ///< new で解答を生成する関数
+};
+
+//------------------------------------------------------------------------------
+/// 名前を付けた解答の登録簿。
+///
+/// HPC_REGISTER_ANSWER で、静的初期化の時に登録します。
+/// 提出する Answer は "answer" の名前で登録済みです。
+class AnswerRegistry
+{
+public:
+    static AnswerRegistry& Instance();                      ///< インスタンスを取得します。
+
+    bool add(const char* aName, AnswerVariant* (*aCreate)());   ///< 解答を登録します。
+    const AnswerEntry* find(const char* aName)const;        ///< 名前から解答を探します。見つからなければ nullptr。
+    int count()const;                                       ///< 登録された解答の数を取得します。
+    const AnswerEntry& entry(int aIndex)const;              ///< 登録された解答を取得します。
+
+private:
+    AnswerRegistry();
+
+    std::vector<AnswerEntry> mEntries;                      ///< 登録された順の解答
+};
+
+} // namespace
+
+#define HPC_REGISTER_ANSWER_NAME_HELPER(aCounter) sAnswerRegistered ## aCounter
+#define HPC_REGISTER_ANSWER_NAME(aCounter) HPC_REGISTER_ANSWER_NAME_HELPER(aCounter)
+
+/// 解答のクラス aType を aName の名前で登録します。名前空間のスコープに書いてください。
+#define HPC_REGISTER_ANSWER(aName, aType) \
+    static const bool HPC_REGISTER_ANSWER_NAME(__COUNTER__) = \
+        ::hpc::AnswerRegistry::Instance().add(aName, &::hpc::AnswerVariantOf<aType>::Create)
+
+// EOF
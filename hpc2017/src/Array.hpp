@@ -14,12 +14,51 @@
 
 namespace hpc {
 
+//------------------------------------------------------------------------------
+/// インデックスの範囲と追加時の空きを検査する Array のポリシー。
+struct ArrayCheckedPolicy
+{
+    /// インデックスが [0, aCount) にあることを検査します。
+    static void CheckIndex(const int aIndex, const int aCount)
+    {
+        HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, aCount);
+    }
+
+    /// 要素を追加できることを検査します。
+    static void CheckAdd(const bool aIsFull)
+    {
+        HPC_ASSERT(!aIsFull);
+    }
+};
+
+//------------------------------------------------------------------------------
+/// 何も検査しない Array のポリシー。
+///
+/// 範囲外のアクセスは未定義動作になります。検査付きのビルドで確かめてから使ってください。
+struct ArrayUncheckedPolicy
+{
+    static void CheckIndex(const int, const int) {}
+    static void CheckAdd(const bool) {}
+};
+
+//------------------------------------------------------------------------------
+/// Array の既定のポリシー。
+///
+/// DEBUG か HPC_CHECKED を定義したビルドでは検査し、それ以外では検査しません。
+#if defined(DEBUG) || defined(HPC_CHECKED)
+typedef ArrayCheckedPolicy ArrayDefaultPolicy;
+#else
+typedef ArrayUncheckedPolicy ArrayDefaultPolicy;
+#endif
+
+//------------------------------------------------------------------------------
 /// 最大要素数を指定する可変長配列。
 ///
 /// - TElementにはデストラクタを持つクラスを指定しないでください(正しく呼び出されません)
 /// - std::vectorと違い、初期化時にstd::arrayで最大数分のメモリを確保するため
 ///   このクラスからnew, deleteが呼ばれることはありません。
-template <typename TElement, int TCapacity>
+/// - TCheckPolicy で、インデックスの範囲と追加時の空きを検査するかを指定します。
+template <typename TElement, int TCapacity, typename TCheckPolicy = ArrayDefaultPolicy>
 class Array
 {
 public:
@@ -50,7 +89,7 @@ public:
     /// static const intでないのは、コンパイラによる挙動の違いを避けるためです。
     inline int maxCount() const;
 
-    /// @name 要素にアクセスします。インデックスの範囲チェックを行います。
+    /// @name 要素にアクセスします。ポリシーに従ってインデックスの範囲チェックを行います。
     //@{
     inline TElement& operator[](const int aIndex);
     inline const TElement& operator[](const int aIndex) const;
@@ -76,24 +115,24 @@ private:
 };
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-Array<TElement, TCapacity>::Array()
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+Array<TElement, TCapacity, TCheckPolicy>::Array()
 : mContainer()
 , mCount(0)
 {
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-Array<TElement, TCapacity>::~Array()
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+Array<TElement, TCapacity, TCheckPolicy>::~Array()
 {
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-void Array<TElement, TCapacity>::add(const TElement& aData)
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+void Array<TElement, TCapacity, TCheckPolicy>::add(const TElement& aData)
 {
-    HPC_ASSERT(!isFull());
+    TCheckPolicy::CheckAdd(isFull());
 
     // 追加
     mContainer[mCount] = aData;
@@ -101,80 +140,80 @@ void Array<TElement, TCapacity>::add(const TElement& aData)
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-void Array<TElement, TCapacity>::clear()
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+void Array<TElement, TCapacity, TCheckPolicy>::clear()
 {
     mCount = 0;
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-int Array<TElement, TCapacity>::count() const
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+int Array<TElement, TCapacity, TCheckPolicy>::count() const
 {
     return mCount;
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-int Array<TElement, TCapacity>::maxCount() const
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+int Array<TElement, TCapacity, TCheckPolicy>::maxCount() const
 {
     return TCapacity;
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-TElement& Array<TElement, TCapacity>::operator[](const int aIndex)
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+TElement& Array<TElement, TCapacity, TCheckPolicy>::operator[](const int aIndex)
 {
-    HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, mCount);
+    TCheckPolicy::CheckIndex(aIndex, mCount);
     return mContainer[aIndex];
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-const TElement& Array<TElement, TCapacity>::operator[](const int aIndex) const
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+const TElement& Array<TElement, TCapacity, TCheckPolicy>::operator[](const int aIndex) const
 {
-    HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, mCount);
+    TCheckPolicy::CheckIndex(aIndex, mCount);
     return mContainer[aIndex];
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-typename Array<TElement, TCapacity>::iterator Array<TElement, TCapacity>::begin()
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+typename Array<TElement, TCapacity, TCheckPolicy>::iterator Array<TElement, TCapacity, TCheckPolicy>::begin()
 {
     return mContainer.begin();
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-typename Array<TElement, TCapacity>::iterator Array<TElement, TCapacity>::end()
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+typename Array<TElement, TCapacity, TCheckPolicy>::iterator Array<TElement, TCapacity, TCheckPolicy>::end()
 {
     return mContainer.begin() + mCount;
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-typename Array<TElement, TCapacity>::const_iterator Array<TElement, TCapacity>::begin() const
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+typename Array<TElement, TCapacity, TCheckPolicy>::const_iterator Array<TElement, TCapacity, TCheckPolicy>::begin() const
 {
     return mContainer.begin();
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-typename Array<TElement, TCapacity>::const_iterator Array<TElement, TCapacity>::end() const
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+typename Array<TElement, TCapacity, TCheckPolicy>::const_iterator Array<TElement, TCapacity, TCheckPolicy>::end() const
 {
     return mContainer.begin() + mCount;
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-bool Array<TElement, TCapacity>::isEmpty() const
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+bool Array<TElement, TCapacity, TCheckPolicy>::isEmpty() const
 {
     return mCount == 0;
 }
 
 //------------------------------------------------------------------------------
-template <typename TElement, int TCapacity>
-bool Array<TElement, TCapacity>::isFull() const
+template <typename TElement, int TCapacity, typename TCheckPolicy>
+bool Array<TElement, TCapacity, TCheckPolicy>::isFull() const
 {
     return mCount == TCapacity;
 }
@@ -0,0 +1,455 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+// ベンチマークのエントリポイントです。
+// CombineBench.cpp から、Answer.cpp を含むすべてのファイルの後にインクルードされます。
+// (Main.cpp とは別の実行ファイルになります)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Answer.hpp"
+#include "Game.hpp"
+#include "Print.hpp"
+#include "Recorder.hpp"
+#include "Stage.hpp"
+
+namespace {
+
+//------------------------------------------------------------------------------
+/// ベンチマークの設定。
+struct BenchConfig
+{
+    int warmup;                 ///< 計測前に捨てる実行回数
+    int repetition;             ///< 計測する回数
+};
+
+//------------------------------------------------------------------------------
+/// ベンチマークの結果。時間はすべて1操作あたりのナノ秒です。
+struct BenchResult
+{
+    std::string name;           ///< 名前
+    int repetition;             ///< 計測した回数
+    long long opCount;          ///< 1回あたりの操作数
+    double minNs;               ///< 最小値
+    double medianNs;            ///< 中央値
+};
+
+//------------------------------------------------------------------------------
+/// ベースラインとの比較に使う閾値。
+struct BenchThreshold
+{
+    std::string name;           ///< ベンチマークの名前
+    double ratio;               ///< 中央値がこの割合を超えて遅くなれば退行とみなす
+};
+
+//------------------------------------------------------------------------------
+/// ベンチマークを計測します。
+///
+/// aPrepare は計測の対象外で、各回の aBody の前に呼び出します。
+/// aBody は1回につき aOpCount 個の操作を行う必要があります。
+///
+/// @param[in] aName 名前。
+/// @param[in] aConfig 繰り返しの設定。
+/// @param[in] aOpCount 1回あたりの操作数。
+/// @param[in] aPrepare 準備処理。
+/// @param[in] aBody 計測する処理。
+BenchResult Measure(
+    const char* aName,
+    const BenchConfig& aConfig,
+    long long aOpCount,
+    const std::function<void()>& aPrepare,
+    const std::function<void()>& aBody
+    )
+{
+    std::vector<double> samples;
+    for (int i = 0; i < aConfig.warmup + aConfig.repetition; ++i) {
+        aPrepare();
+        const auto begin = std::chrono::steady_clock::now();
+        aBody();
+        const auto end = std::chrono::steady_clock::now();
+        if (i >= aConfig.warmup) {
+            const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+            samples.push_back(ns / double(aOpCount));
+        }
+    }
+    std::sort(samples.begin(), samples.end());
+
+    BenchResult result;
+    result.name = aName;
+    result.repetition = aConfig.repetition;
+    result.opCount = aOpCount;
+    result.minNs = samples.front();
+    result.medianNs = samples[samples.size() / 2];
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/// 標準出力を一時的に捨てます。
+///
+/// Recorder::dumpJson() のように標準出力に書く処理を計測するために使います。
+class StdoutSilencer
+{
+public:
+    StdoutSilencer()
+    : mSavedFd(-1)
+    {
+        std::fflush(stdout);
+        mSavedFd = ::dup(STDOUT_FILENO);
+        const int nullFd = ::open("/dev/null", O_WRONLY);
+        ::dup2(nullFd, STDOUT_FILENO);
+        ::close(nullFd);
+    }
+    ~StdoutSilencer()
+    {
+        std::fflush(stdout);
+        ::dup2(mSavedFd, STDOUT_FILENO);
+        ::close(mSavedFd);
+    }
+private:
+    int mSavedFd;
+};
+
+//------------------------------------------------------------------------------
+/// 計測に使うステージを生成します。
+std::vector<hpc::RandomSeed> StageSeeds(int aCount)
+{
+    std::vector<hpc::RandomSeed> seeds;
+    for (int i = 0; i < aCount; ++i) {
+        seeds.push_back(hpc::Game::StageSeed(hpc::RandomSeed::DefaultSeed(), i));
+    }
+    return seeds;
+}
+
+//------------------------------------------------------------------------------
+/// 初期化済みのステージを取得します。
+hpc::Stage InitStage(const hpc::RandomSeed& aSeed)
+{
+    hpc::Stage stage(aSeed);
+    stage.init();
+    return stage;
+}
+
+//------------------------------------------------------------------------------
+/// 名前が絞り込みの条件に合うかを取得します。
+bool MatchesFilter(const char* aName, const char* aFilter)
+{
+    return aFilter == nullptr || std::strstr(aName, aFilter) != nullptr;
+}
+
+//------------------------------------------------------------------------------
+/// すべてのベンチマークを実行します。
+///
+/// @param[in] aFilter 名前にこの文字列を含むものだけを実行します。nullptr ならすべて。
+/// @param[in] aRepetition 計測する回数。0 以下なら既定値。
+std::vector<BenchResult> RunBenchmarks(const char* aFilter, int aRepetition)
+{
+    using namespace hpc;
+
+    const int StageCount = 200;
+    const std::vector<RandomSeed> seeds = StageSeeds(StageCount);
+    const BenchConfig micro = { 3, aRepetition > 0 ? aRepetition : 20 };
+    const BenchConfig macro = { 0, aRepetition > 0 ? aRepetition : 1 };
+
+    std::vector<BenchResult> results;
+
+    if (MatchesFilter("stage_init", aFilter)) {
+        results.push_back(Measure("stage_init", micro, StageCount,
+            [](){},
+            [&](){
+                for (const auto& seed : seeds) {
+                    Stage stage(seed);
+                    stage.init();
+                }
+            }));
+    }
+
+    if (MatchesFilter("stage_move_items", aFilter)) {
+        // 農場の上で積み込みと受け渡しをし、届かない家への配達を試みる
+        // 何度実行しても同じ分岐をたどるので、1つのステージに繰り返し適用できる
+        const int CallCount = 10000;
+        Stage stage = InitStage(seeds[0]);
+        Actions actions;
+        for (int i = 0; i < Parameter::UFOCount; ++i) {
+            actions.add(Action::PickUp(i));
+        }
+        for (int i = 1; i < Parameter::UFOCount; ++i) {
+            actions.add(Action::Pass(0, i));
+        }
+        for (int i = 0; i < stage.houses().count() && actions.count() < Parameter::MaxActionPerTurn; ++i) {
+            actions.add(Action::Deliver(i % Parameter::UFOCount, i));
+        }
+        results.push_back(Measure("stage_move_items", micro, CallCount,
+            [](){},
+            [&](){
+                for (int i = 0; i < CallCount; ++i) {
+                    stage.moveItems(actions);
+                }
+            }));
+    }
+
+    if (MatchesFilter("stage_move_ufos", aFilter)) {
+        // 2点の間を往復させる
+        const int CallCount = 10000;
+        Stage stage = InitStage(seeds[0]);
+        TargetPositions targets[2];
+        for (int i = 0; i < Parameter::UFOCount; ++i) {
+            targets[0].add(Vector2(100.0f + 50.0f * i, 100.0f));
+            targets[1].add(Vector2(100.0f + 50.0f * i, 650.0f));
+        }
+        results.push_back(Measure("stage_move_ufos", micro, CallCount,
+            [](){},
+            [&](){
+                for (int i = 0; i < CallCount; ++i) {
+                    stage.moveUFOs(targets[(i / 50) % 2]);
+                }
+            }));
+    }
+
+    if (MatchesFilter("recorder_after_advance_turn", aFilter)) {
+        // Recorder は大きいので、ヒープに置く
+        std::unique_ptr<Recorder> recorder;
+        const Stage stage = InitStage(seeds[0]);
+        results.push_back(Measure("recorder_after_advance_turn", micro, Parameter::GameTurnLimit,
+            [&](){
+                recorder.reset(new Recorder());
+                recorder->afterInitStage(stage);
+            },
+            [&](){
+                for (int i = 0; i < Parameter::GameTurnLimit; ++i) {
+                    recorder->afterAdvanceTurn(stage);
+                }
+            }));
+    }
+
+    if (MatchesFilter("recorder_dump_json", aFilter)) {
+        // 1ステージあたり 100 ターンの記録を作る
+        const int TurnPerStage = 100;
+        std::unique_ptr<Recorder> recorder(new Recorder());
+        for (const auto& seed : seeds) {
+            const Stage stage = InitStage(seed);
+            recorder->afterInitStage(stage);
+            for (int i = 0; i < TurnPerStage; ++i) {
+                recorder->afterAdvanceTurn(stage);
+            }
+            recorder->afterFinishStage();
+        }
+        recorder->afterFinishAllStages();
+        results.push_back(Measure("recorder_dump_json", micro, 1,
+            [](){},
+            [&](){
+                StdoutSilencer silencer;
+                recorder->dumpJson();
+            }));
+    }
+
+    if (MatchesFilter("detect_towns", aFilter)) {
+        std::vector<Stage> stages;
+        for (const auto& seed : seeds) {
+            stages.push_back(InitStage(seed));
+        }
+        results.push_back(Measure("detect_towns", micro, StageCount,
+            [](){},
+            [&](){
+                for (const auto& stage : stages) {
+                    // 街の検出は作業用メモリから確保するので、呼ぶたびに巻き戻して使い回す
+                    Solver::scratch_scope_t scope;
+                    Solver::detect_towns(stage.houses());
+                }
+            }));
+    }
+
+    if (MatchesFilter("game_run", aFilter)) {
+        // ログの記録は recorder_* で測るので、記録しないゲームで解答とステージだけを測る
+        std::unique_ptr<BenchGame> game;
+        results.push_back(Measure("game_run", macro, 1,
+            [&](){
+                game.reset(new BenchGame(RandomSeed::DefaultSeed()));
+            },
+            [&](){
+                // 解答のログ出力は標準エラー出力なので、そのままにする
+                Answer answer;
+                game->run(answer);
+            }));
+    }
+
+    return results;
+}
+
+//------------------------------------------------------------------------------
+/// 結果を Json 形式で書き出します。
+///
+/// 比較のため、ベンチマークごとに1行で書き出します。
+void WriteJson(std::FILE* aFile, const std::vector<BenchResult>& aResults)
+{
+    std::fprintf(aFile, "{\n  \"benchmarks\": [\n");
+    for (int i = 0; i < int(aResults.size()); ++i) {
+        const BenchResult& result = aResults[i];
+        std::fprintf(aFile,
+            "    {\"name\": \"%s\", \"repetition\": %d, \"ops\": %lld, \"min_ns\": %.1f, \"median_ns\": %.1f}%s\n",
+            result.name.c_str(), result.repetition, result.opCount, result.minNs, result.medianNs,
+            i + 1 < int(aResults.size()) ? "," : "");
+    }
+    std::fprintf(aFile, "  ]\n}\n");
+}
+
+//------------------------------------------------------------------------------
+/// WriteJson() で書き出した Json を読み込みます。
+bool ReadJson(const char* aPath, std::vector<BenchResult>& aResults)
+{
+    std::FILE* file = std::fopen(aPath, "r");
+    if (file == nullptr) {
+        return false;
+    }
+    char line[512];
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+        char name[128];
+        BenchResult result;
+        if (std::sscanf(line,
+                " {\"name\": \"%127[^\"]\", \"repetition\": %d, \"ops\": %lld, \"min_ns\": %lf, \"median_ns\": %lf",
+                name, &result.repetition, &result.opCount, &result.minNs, &result.medianNs) == 5
+            ) {
+            result.name = name;
+            aResults.push_back(result);
+        }
+    }
+    std::fclose(file);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// ベースラインと比較し、結果を標準エラー出力に書き出します。
+///
+/// @return 退行したベンチマークの数。
+int CompareWithBaseline(
+    const std::vector<BenchResult>& aResults,
+    const std::vector<BenchResult>& aBaseline,
+    double aDefaultThreshold,
+    const std::vector<BenchThreshold>& aThresholds
+    )
+{
+    int regressionCount = 0;
+    std::fprintf(stderr, "%-28s %14s %14s %8s %8s\n", "name", "baseline[ns]", "current[ns]", "change", "limit");
+    for (const auto& result : aResults) {
+        const BenchResult* base = nullptr;
+        for (const auto& candidate : aBaseline) {
+            if (candidate.name == result.name) {
+                base = &candidate;
+            }
+        }
+        if (base == nullptr) {
+            std::fprintf(stderr, "%-28s %14s %14.1f\n", result.name.c_str(), "-", result.medianNs);
+            continue;
+        }
+        double threshold = aDefaultThreshold;
+        for (const auto& t : aThresholds) {
+            if (t.name == result.name) {
+                threshold = t.ratio;
+            }
+        }
+        const double change = result.medianNs / base->medianNs - 1.0;
+        const bool regressed = change > threshold;
+        if (regressed) {
+            ++regressionCount;
+        }
+        std::fprintf(stderr, "%-28s %14.1f %14.1f %+7.1f%% %+7.1f%%%s\n",
+            result.name.c_str(), base->medianNs, result.medianNs, change * 100.0, threshold * 100.0,
+            regressed ? "  REGRESSION" : "");
+    }
+    return regressionCount;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/// ベンチマークのエントリポイントです。
+///
+/// -o file      : 結果の Json の書き出し先 (既定は標準出力)
+/// -b file      : 比較するベースラインの Json
+/// -t ratio     : 退行とみなす中央値の増加率 (既定は 0.10)
+/// -T name=ratio: ベンチマークごとの増加率
+/// -f text      : 名前に text を含むベンチマークだけを実行
+/// -n count     : 計測する回数
+///
+/// @return ベースラインから退行していれば 1 を返します。
+int main(int argc, const char* argv[])
+{
+    const char* outputPath = nullptr;
+    const char* baselinePath = nullptr;
+    const char* filter = nullptr;
+    int repetition = 0;
+    double defaultThreshold = 0.10;
+    std::vector<BenchThreshold> thresholds;
+
+    for (int n = 1; n < argc; ++n) {
+        const bool hasValue = n + 1 < argc;
+        if (!std::strcmp(argv[n], "-o") && hasValue) {
+            outputPath = argv[++n];
+        } else if (!std::strcmp(argv[n], "-b") && hasValue) {
+            baselinePath = argv[++n];
+        } else if (!std::strcmp(argv[n], "-t") && hasValue) {
+            defaultThreshold = std::strtod(argv[++n], nullptr);
+        } else if (!std::strcmp(argv[n], "-T") && hasValue) {
+            const char* arg = argv[++n];
+            const char* separator = std::strchr(arg, '=');
+            if (separator == nullptr) {
+                HPC_PRINTF("Invalid Argument.(-T) need name=ratio.\n");
+                return 1;
+            }
+            BenchThreshold threshold;
+            threshold.name = std::string(arg, separator);
+            threshold.ratio = std::strtod(separator + 1, nullptr);
+            thresholds.push_back(threshold);
+        } else if (!std::strcmp(argv[n], "-f") && hasValue) {
+            filter = argv[++n];
+        } else if (!std::strcmp(argv[n], "-n") && hasValue) {
+            repetition = int(std::strtol(argv[++n], nullptr, 0));
+        } else {
+            HPC_PRINTF("Invalid Argument.(%s)\n", argv[n]);
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> baseline;
+    if (baselinePath != nullptr && !ReadJson(baselinePath, baseline)) {
+        HPC_PRINTF("Invalid Argument.(-b) can't open baseline file.(%s)\n", baselinePath);
+        return 1;
+    }
+
+    const std::vector<BenchResult> results = RunBenchmarks(filter, repetition);
+
+    if (outputPath != nullptr) {
+        std::FILE* file = std::fopen(outputPath, "w");
+        if (file == nullptr) {
+            HPC_PRINTF("Invalid Argument.(-o) can't create output file.(%s)\n", outputPath);
+            return 1;
+        }
+        WriteJson(file, results);
+        std::fclose(file);
+    } else {
+        WriteJson(stdout, results);
+    }
+
+    if (baselinePath != nullptr) {
+        return CompareWithBaseline(results, baseline, defaultThreshold, thresholds) == 0 ? 0 : 1;
+    }
+    return 0;
+}
+
+// EOF
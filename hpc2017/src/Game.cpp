@@ -9,81 +9,721 @@
 
 #include "Game.hpp"
 
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <time.h>
+#include "AllocTracker.hpp"
 #include "Assert.hpp"
+#include "Math.hpp"
+#include "ResultPipeline.hpp"
+#include "StageContext.hpp"
+#include "Stats.hpp"
 
 namespace hpc {
 
 //------------------------------------------------------------------------------
-/// Game クラスのインスタンスを生成します。
-Game::Game(RandomSeed aSeed)
+/// BasicGame クラスのインスタンスを生成します。
+template <class TRecorder, class TTimer>
+BasicGame<TRecorder, TTimer>::BasicGame(RandomSeed aSeed)
 : mRandom(aSeed)
+, mStageIndex(0)
+, mPlacementMode(PlacementMode_Legacy)
+, mPlanWriter(nullptr)
 , mRecorder()
 , mTimer()
 {
 }
 
+//------------------------------------------------------------------------------
+/// ステージのシード値を取得します。
+///
+/// run() が aStageIndex 番目のステージに使うシード値を、前のステージを生成せずに求めます。
+///
+/// @param[in] aSeed ゲームのシード値。
+/// @param[in] aStageIndex ステージの番号。
+template <class TRecorder, class TTimer>
+RandomSeed BasicGame<TRecorder, TTimer>::StageSeed(RandomSeed aSeed, int aStageIndex)
+{
+    return StageSeedAt(Random(aSeed), aStageIndex);
+}
+
 //------------------------------------------------------------------------------
 /// シード値を変更します。
 ///
 /// @param[in] aSeed 新しいシード値。
-void Game::changeSeed(RandomSeed aSeed)
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::changeSeed(RandomSeed aSeed)
 {
     mRandom = Random(aSeed);
+    mStageIndex = 0;
+}
+
+//------------------------------------------------------------------------------
+/// ステージを生成せずに読み飛ばします。
+///
+/// 以降の run() や writeCorpus() は、aStageCount 個先のステージから始まります。
+///
+/// @param[in] aStageCount 読み飛ばすステージ数。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::skipStages(int aStageCount)
+{
+    HPC_MIN_ASSERT_I(aStageCount, 0);
+    mRandom.jump(uint64_t(aStageCount) * RandomCountPerStage);
+    mStageIndex += aStageCount;
+}
+
+//------------------------------------------------------------------------------
+/// ステージ生成時の家の配置方法を変更します。
+///
+/// @param[in] aMode 配置方法。既定は既存のシード値と同じ配置になる PlacementMode_Legacy です。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::changePlacementMode(PlacementMode aMode)
+{
+    HPC_ENUM_ASSERT(PlacementMode, aMode);
+    mPlacementMode = aMode;
 }
 
 //------------------------------------------------------------------------------
 /// ゲームを実行します。
 ///
 /// @param[in] aAnswer ゲームの解答。
-void Game::run(Answer& aAnswer)
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::run(Answer& aAnswer)
 {
     mTimer.start();
 
     for(int i = 0; i < Parameter::GameStageCount; ++i) {
-        uint w = mRandom.randU32();
-        uint z = mRandom.randU32();
-        uint y = mRandom.randU32();
-        uint x = mRandom.randU32();
-        RandomSeed seed(x, y, z, w);
-
+        HPC_ALLOC_BEGIN_STAGE();
+        HPC_ALLOC_SET_PHASE(StageGeneration);
+        const RandomSeed seed = NextStageSeed(mRandom);
         Stage stage(seed);
-        stage.init();
-        aAnswer.init(stage);
+        stage.init(mPlacementMode);
+        HPC_ALLOC_SET_PHASE(Other);
+        if (mPlanWriter != nullptr) {
+            mPlanWriter->beginStage(seed, mPlacementMode);
+        }
+        StageContext::SetIndex(mStageIndex++);
+        runStage(aAnswer, stage);
+        if (mPlanWriter != nullptr) {
+            mPlanWriter->endStage();
+        }
+        HPC_ALLOC_END_STAGE();
+    }
+    HPC_ALLOC_SET_PHASE(Recorder);
+    mRecorder.afterFinishAllStages();
+    HPC_ALLOC_SET_PHASE(Other);
+
+    mTimer.stop();
+}
+
+//------------------------------------------------------------------------------
+/// コーパスのステージでゲームを実行します。
+///
+/// ステージは生成せず、コーパスから順に読み込みます。
+/// コーパスのステージ数が Parameter::GameStageCount と異なっていても構いません。
+///
+/// @param[in] aAnswer ゲームの解答。
+/// @param[in] aCorpus 開いているステージコーパス。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::run(Answer& aAnswer, const StageCorpus& aCorpus)
+{
+    HPC_ASSERT(aCorpus.isOpen());
+    // コーパスのステージにはシード値がないので、プランには記録できない
+    HPC_ASSERT(mPlanWriter == nullptr);
+
+    mTimer.start();
+
+    for(int i = 0; i < aCorpus.stageCount(); ++i) {
+        HPC_ALLOC_BEGIN_STAGE();
+        HPC_ALLOC_SET_PHASE(StageGeneration);
+        Stage stage(RandomSeed::DefaultSeed());
+        aCorpus.initStage(i, stage);
+        HPC_ALLOC_SET_PHASE(Other);
+        StageContext::SetIndex(i);
+        runStage(aAnswer, stage);
+        HPC_ALLOC_END_STAGE();
+    }
+    HPC_ALLOC_SET_PHASE(Recorder);
+    mRecorder.afterFinishAllStages();
+    HPC_ALLOC_SET_PHASE(Other);
+
+    mTimer.stop();
+}
+
+//------------------------------------------------------------------------------
+/// ステージを並列に実行します。
+///
+/// run() と同じステージを aThreadCount 個のワーカースレッドで実行します。
+/// ワーカーはそれぞれ Answer を持ちます。結果は ResultPipeline がステージの番号順に書き出し、
+/// ログ記録器にはステージのターン数だけを記録します。
+///
+/// @param[in] aThreadCount ワーカーの数。
+/// @param[in] aIsSilent ステージごとの行を出力しないか。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::runParallel(int aThreadCount, bool aIsSilent)
+{
+    runWorkers(aThreadCount, aIsSilent, nullptr);
+}
+
+//------------------------------------------------------------------------------
+/// コーパスのステージを並列に実行します。
+///
+/// @param[in] aThreadCount ワーカーの数。
+/// @param[in] aIsSilent ステージごとの行を出力しないか。
+/// @param[in] aCorpus 開いているステージコーパス。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::runParallel(int aThreadCount, bool aIsSilent, const StageCorpus& aCorpus)
+{
+    HPC_ASSERT(aCorpus.isOpen());
+    runWorkers(aThreadCount, aIsSilent, &aCorpus);
+}
+
+//------------------------------------------------------------------------------
+/// 複数の解答を同じステージで実行します。
+///
+/// run() と同じステージを、aEntries の解答がそれぞれ最初から解きます。
+/// ログ記録器とプランには記録せず、ターン数と CPU 時間を aResult に記録します。
+///
+/// @param[in] aEntries 比べる解答。先頭の解答が基準になります。
+/// @param[in] aThreadCount ワーカーの数。
+/// @param[out] aResult 実行した結果。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::runTournament(const std::vector<const AnswerEntry*>& aEntries, int aThreadCount, Tournament& aResult)
+{
+    runTournamentWorkers(aEntries, aThreadCount, aResult, nullptr);
+}
+
+//------------------------------------------------------------------------------
+/// 複数の解答をコーパスのステージで実行します。
+///
+/// @param[in] aEntries 比べる解答。先頭の解答が基準になります。
+/// @param[in] aThreadCount ワーカーの数。
+/// @param[out] aResult 実行した結果。
+/// @param[in] aCorpus 開いているステージコーパス。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::runTournament(const std::vector<const AnswerEntry*>& aEntries, int aThreadCount, Tournament& aResult, const StageCorpus& aCorpus)
+{
+    HPC_ASSERT(aCorpus.isOpen());
+    runTournamentWorkers(aEntries, aThreadCount, aResult, &aCorpus);
+}
+
+//------------------------------------------------------------------------------
+/// 定数の設定を successive halving で比べます。
+///
+/// run() と同じステージを、aTuner の設定ごとに提出する解答で解きます。
+/// ログ記録器とプランには記録せず、ターン数と CPU 時間を aTuner に記録します。
+///
+/// @param[in,out] aTuner 比べる設定。結果もここに記録します。
+/// @param[in] aThreadCount ワーカーの数。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::runTuning(Tuner& aTuner, int aThreadCount)
+{
+    runTuningWorkers(aTuner, aThreadCount, nullptr);
+}
+
+//------------------------------------------------------------------------------
+/// 定数の設定をコーパスのステージで比べます。
+///
+/// @param[in,out] aTuner 比べる設定。結果もここに記録します。
+/// @param[in] aThreadCount ワーカーの数。
+/// @param[in] aCorpus 開いているステージコーパス。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::runTuning(Tuner& aTuner, int aThreadCount, const StageCorpus& aCorpus)
+{
+    HPC_ASSERT(aCorpus.isOpen());
+    runTuningWorkers(aTuner, aThreadCount, &aCorpus);
+}
+
+//------------------------------------------------------------------------------
+/// ステージを生成してコーパスに書き出します。
+///
+/// シード値から run() と同じ順番でステージを生成します。
+/// 参照ターン数は記録しません。
+///
+/// @param[in] aPath コーパスファイルのパス。
+/// @param[in] aStageCount 生成するステージ数。
+/// @return 書き出しに成功すれば true を返します。
+template <class TRecorder, class TTimer>
+bool BasicGame<TRecorder, TTimer>::writeCorpus(const char* aPath, int aStageCount)
+{
+    StageCorpusWriter writer;
+    if (!writer.open(aPath)) {
+        return false;
+    }
+
+    for(int i = 0; i < aStageCount; ++i) {
+        Stage stage(NextStageSeed(mRandom));
+        ++mStageIndex;
+        stage.init(mPlacementMode);
+        if (!writer.add(stage, StageCorpusFormat::NoReferenceTurn)) {
+            return false;
+        }
+    }
+
+    return writer.close();
+}
+
+//------------------------------------------------------------------------------
+/// run() が実行するステージの下界を求めます。
+///
+/// 乱数生成器の複製からステージを生成するので、この後の run() には影響しません。
+///
+/// @param[out] aBounds ステージごとの下界。
+/// @param[in] aCorpus 開いているステージコーパス。生成したステージを使うなら nullptr。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::computeBounds(std::vector<StageBound>& aBounds, const StageCorpus* aCorpus)const
+{
+    aBounds.clear();
+    if (aCorpus != nullptr) {
+        for(int i = 0; i < aCorpus->stageCount(); ++i) {
+            Stage stage(RandomSeed::DefaultSeed());
+            aCorpus->initStage(i, stage);
+            aBounds.push_back(LowerBound::Compute(stage));
+        }
+        return;
+    }
+
+    Random random = mRandom;
+    for(int i = 0; i < Parameter::GameStageCount; ++i) {
+        Stage stage(NextStageSeed(random));
+        stage.init(mPlacementMode);
+        aBounds.push_back(LowerBound::Compute(stage));
+    }
+}
+
+//------------------------------------------------------------------------------
+/// 解答を使わずにプランを再生します。
+///
+/// プランの行動と目標座標をそのままステージに与え、ターン数をログ記録器に記録します。
+/// プランどおりに進まなかったステージは aResult に記録します。
+///
+/// @param[in] aReader 開いているプランファイル。
+/// @param[out] aResult 再生した結果。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::replay(PlanReader& aReader, PlanVerification& aResult)
+{
+    mTimer.start();
+
+    aResult.stages.clear();
+    aResult.broken = false;
+
+    PlanStage plan;
+    for(int i = 0; i < aReader.stageCount(); ++i) {
+        if (!aReader.readStage(plan)) {
+            aResult.broken = true;
+            break;
+        }
+
+        Stage stage(plan.seed);
+        stage.init(plan.placementMode);
+        HPC_STATS_ADD(stageCount, 1);
         mRecorder.afterInitStage(stage);
-        while(!stage.hasFinished() && stage.turn() < Parameter::GameTurnLimit) {
-            Actions actions;
-            aAnswer.moveItems(stage, actions);
-            stage.moveItems(actions);
 
-            TargetPositions targetPositions;
-            aAnswer.moveUFOs(stage, targetPositions);
-            stage.moveUFOs(targetPositions);
+        PlanVerification::StageResult result;
+        result.planTurnCount = int(plan.turns.size());
+        result.rejectedActionCount = 0;
+        result.invalid = false;
+        for (const auto& turn : plan.turns) {
+            if (stage.hasFinished()) {
+                break;
+            }
+
+            // 範囲外の値はステージのアサートに掛かるので、先に確かめる
+            for (const auto& action : turn.actions) {
+                if (action.type() == ActionType_Deliver && action.houseIndex() >= stage.houses().count()) {
+                    result.invalid = true;
+                }
+            }
+            for (const auto& pos : turn.targetPositions) {
+                if (!Math::IsValid(pos.x) || !Math::IsValid(pos.y)) {
+                    result.invalid = true;
+                }
+            }
+            if (result.invalid) {
+                break;
+            }
 
+            HPC_STATS_SET_IN_GAME(true);
+            result.rejectedActionCount += stage.moveItems(turn.actions);
+            stage.moveUFOs(turn.targetPositions);
+            HPC_STATS_SET_IN_GAME(false);
             stage.advanceTurn();
 
             mRecorder.afterAdvanceTurn(stage);
         }
         mRecorder.afterFinishStage();
-        aAnswer.finalize(stage);
+
+        result.turn = stage.turn();
+        result.finished = stage.hasFinished();
+        aResult.stages.push_back(result);
     }
     mRecorder.afterFinishAllStages();
 
     mTimer.stop();
 }
 
+//------------------------------------------------------------------------------
+/// run() の解答を記録するプランの書き出し先を変更します。
+///
+/// @param[in] aWriter 開いているプランの書き出し先。記録しなければ nullptr。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::changePlanWriter(PlanWriter* aWriter)
+{
+    mPlanWriter = aWriter;
+}
+
 //------------------------------------------------------------------------------
 /// ログ記録器を取得します。
-const Recorder& Game::recorder()const
+template <class TRecorder, class TTimer>
+const TRecorder& BasicGame<TRecorder, TTimer>::recorder()const
 {
     return mRecorder;
 }
 
 //------------------------------------------------------------------------------
 /// タイマーを取得します。
-const Timer& Game::timer()const
+template <class TRecorder, class TTimer>
+const TTimer& BasicGame<TRecorder, TTimer>::timer()const
 {
     return mTimer;
 }
 
+//------------------------------------------------------------------------------
+/// 乱数生成器から次のステージのシード値を取得します。
+template <class TRecorder, class TTimer>
+RandomSeed BasicGame<TRecorder, TTimer>::NextStageSeed(Random& aRandom)
+{
+    uint w = aRandom.randU32();
+    uint z = aRandom.randU32();
+    uint y = aRandom.randU32();
+    uint x = aRandom.randU32();
+    return RandomSeed(x, y, z, w);
+}
+
+//------------------------------------------------------------------------------
+/// 乱数生成器から aStageIndex 個先のステージのシード値を取得します。
+///
+/// aRandom は進めないので、ワーカーは番号から直接シード値を求められます。
+template <class TRecorder, class TTimer>
+RandomSeed BasicGame<TRecorder, TTimer>::StageSeedAt(const Random& aRandom, int aStageIndex)
+{
+    HPC_MIN_ASSERT_I(aStageIndex, 0);
+    Random random = aRandom;
+    random.jump(uint64_t(aStageIndex) * RandomCountPerStage);
+    return NextStageSeed(random);
+}
+
+//------------------------------------------------------------------------------
+/// 記録せずにステージを実行します。
+///
+/// ログ記録器もプランの書き出し先も使わないので、ワーカースレッドから呼び出せます。
+/// TAnswer は Answer か AnswerVariant です。
+///
+/// @param[in] aAnswer ワーカーの解答。
+/// @param[in] aStage 初期化済みのステージ。
+/// @param[out] aPlan 解答のプランを追加する先。記録しなければ nullptr。
+template <class TRecorder, class TTimer>
+template <class TAnswer>
+void BasicGame<TRecorder, TTimer>::PlayStage(TAnswer& aAnswer, Stage& aStage, PlanStage* aPlan)
+{
+    HPC_STATS_ADD(stageCount, 1);
+    aAnswer.init(aStage);
+    while(!aStage.hasFinished() && aStage.turn() < Parameter::GameTurnLimit) {
+        PlanTurn turn;
+        aAnswer.moveItems(aStage, turn.actions);
+        HPC_STATS_SET_IN_GAME(true);
+        aStage.moveItems(turn.actions);
+        HPC_STATS_SET_IN_GAME(false);
+
+        aAnswer.moveUFOs(aStage, turn.targetPositions);
+        HPC_STATS_SET_IN_GAME(true);
+        aStage.moveUFOs(turn.targetPositions);
+        HPC_STATS_SET_IN_GAME(false);
+
+        if (aPlan != nullptr) {
+            aPlan->turns.push_back(turn);
+        }
+
+        aStage.advanceTurn();
+    }
+    aAnswer.finalize(aStage);
+}
+
+//------------------------------------------------------------------------------
+/// 初期化済みのステージを実行します。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::runStage(Answer& aAnswer, Stage& aStage)
+{
+    HPC_STATS_ADD(stageCount, 1);
+    HPC_ALLOC_SET_PHASE(AnswerInit);
+    aAnswer.init(aStage);
+    HPC_ALLOC_SET_PHASE(Recorder);
+    mRecorder.afterInitStage(aStage);
+    HPC_ALLOC_SET_PHASE(Other);
+    while(!aStage.hasFinished() && aStage.turn() < Parameter::GameTurnLimit) {
+        Actions actions;
+        HPC_ALLOC_SET_PHASE(AnswerTurn);
+        aAnswer.moveItems(aStage, actions);
+        HPC_ALLOC_SET_PHASE(Other);
+        HPC_STATS_SET_IN_GAME(true);
+        aStage.moveItems(actions);
+        HPC_STATS_SET_IN_GAME(false);
+
+        TargetPositions targetPositions;
+        HPC_ALLOC_SET_PHASE(AnswerTurn);
+        aAnswer.moveUFOs(aStage, targetPositions);
+        HPC_ALLOC_SET_PHASE(Other);
+        HPC_STATS_SET_IN_GAME(true);
+        aStage.moveUFOs(targetPositions);
+        HPC_STATS_SET_IN_GAME(false);
+
+        if (mPlanWriter != nullptr) {
+            mPlanWriter->addTurn(actions, targetPositions);
+        }
+
+        aStage.advanceTurn();
+
+        HPC_ALLOC_SET_PHASE(Recorder);
+        mRecorder.afterAdvanceTurn(aStage);
+        HPC_ALLOC_SET_PHASE(Other);
+    }
+    HPC_ALLOC_SET_PHASE(Recorder);
+    mRecorder.afterFinishStage();
+    HPC_ALLOC_SET_PHASE(AnswerFinalize);
+    aAnswer.finalize(aStage);
+    HPC_ALLOC_SET_PHASE(Other);
+}
+
+//------------------------------------------------------------------------------
+/// ワーカーでステージを並列に実行します。
+///
+/// ワーカーは次のステージの番号を取り合い、シード値は Random::jump() で番号から直接求めます。
+///
+/// @param[in] aThreadCount ワーカーの数。
+/// @param[in] aIsSilent ステージごとの行を出力しないか。
+/// @param[in] aCorpus ステージコーパス。シード値からステージを生成するなら nullptr。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::runWorkers(int aThreadCount, bool aIsSilent, const StageCorpus* aCorpus)
+{
+    HPC_LB_ASSERT_I(aThreadCount, 0);
+    // コーパスのステージにはシード値がないので、プランには記録できない
+    HPC_ASSERT(aCorpus == nullptr || mPlanWriter == nullptr);
+
+    mTimer.start();
+
+    const int stageCount = aCorpus != nullptr ? aCorpus->stageCount() : Parameter::GameStageCount;
+    const Random random = mRandom;
+    const int firstStageIndex = mStageIndex;
+    std::atomic<int> nextStage(0);
+    ResultPipeline pipeline(mPlanWriter, aIsSilent);
+    pipeline.start();
+
+    auto work = [&]() {
+        Answer answer;
+        for (;;) {
+            const int i = nextStage.fetch_add(1);
+            if (i >= stageCount) {
+                break;
+            }
+            pipeline.waitForSlot(i);
+
+            const RandomSeed seed = aCorpus == nullptr ? StageSeedAt(random, i) : RandomSeed::DefaultSeed();
+            Stage stage(seed);
+            if (aCorpus != nullptr) {
+                aCorpus->initStage(i, stage);
+            } else {
+                stage.init(mPlacementMode);
+            }
+
+            StageOutput* output = new StageOutput();
+            output->stageIndex = i;
+            PlanStage* plan = nullptr;
+            if (mPlanWriter != nullptr) {
+                plan = &output->plan;
+                plan->seed = seed;
+                plan->placementMode = mPlacementMode;
+            }
+            StageContext::SetIndex(aCorpus == nullptr ? firstStageIndex + i : i);
+            PlayStage(answer, stage, plan);
+            output->turn = stage.turn();
+            pipeline.push(output);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < aThreadCount; ++i) {
+        workers.push_back(std::thread(work));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    pipeline.finish(stageCount);
+    for (int turn : pipeline.stageTurns()) {
+        mRecorder.addStageTurn(turn);
+    }
+    mRecorder.afterFinishAllStages();
+
+    if (aCorpus == nullptr) {
+        mRandom.jump(uint64_t(stageCount) * RandomCountPerStage);
+        mStageIndex += stageCount;
+    }
+
+    mTimer.stop();
+}
+
+//------------------------------------------------------------------------------
+/// ワーカーで複数の解答を実行します。
+///
+/// ステージと解答の組を1つの仕事として、ワーカーが番号を取り合います。
+/// ステージは仕事ごとに生成し直すので、どの解答も同じ初期状態から解きます。
+/// 解答の CPU 時間はスレッドの CPU 時間で測るので、ワーカーの数に左右されません。
+///
+/// @param[in] aEntries 比べる解答。先頭の解答が基準になります。
+/// @param[in] aThreadCount ワーカーの数。
+/// @param[out] aResult 実行した結果。
+/// @param[in] aCorpus ステージコーパス。シード値からステージを生成するなら nullptr。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::runTournamentWorkers(const std::vector<const AnswerEntry*>& aEntries, int aThreadCount, Tournament& aResult, const StageCorpus* aCorpus)
+{
+    HPC_LB_ASSERT_I(aThreadCount, 0);
+
+    mTimer.start();
+
+    const int stageCount = aCorpus != nullptr ? aCorpus->stageCount() : Parameter::GameStageCount;
+    const int variantCount = int(aEntries.size());
+    aResult.reset(aEntries, stageCount);
+    const Random random = mRandom;
+    const int firstStageIndex = mStageIndex;
+    std::atomic<int> nextTask(0);
+
+    auto work = [&]() {
+        // 解答は初めて使うときに生成し、同じワーカーの以降のステージで使い回す
+        std::vector<std::unique_ptr<AnswerVariant>> answers(variantCount);
+        for (;;) {
+            const int task = nextTask.fetch_add(1);
+            if (task >= stageCount * variantCount) {
+                break;
+            }
+            const int i = task / variantCount;
+            const int v = task % variantCount;
+            if (!answers[v]) {
+                answers[v].reset(aEntries[v]->create());
+            }
+
+            Stage stage(aCorpus == nullptr ? StageSeedAt(random, i) : RandomSeed::DefaultSeed());
+            if (aCorpus != nullptr) {
+                aCorpus->initStage(i, stage);
+            } else {
+                stage.init(mPlacementMode);
+            }
+
+            timespec begin, end;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &begin);
+            StageContext::SetIndex(aCorpus == nullptr ? firstStageIndex + i : i);
+            PlayStage(*answers[v], stage, nullptr);
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+            const double sec = double(end.tv_sec - begin.tv_sec) + double(end.tv_nsec - begin.tv_nsec) * 1e-9;
+            aResult.setResult(v, i, stage.turn(), sec);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < aThreadCount; ++i) {
+        workers.push_back(std::thread(work));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (aCorpus == nullptr) {
+        mRandom.jump(uint64_t(stageCount) * RandomCountPerStage);
+        mStageIndex += stageCount;
+    }
+
+    mTimer.stop();
+}
+
+//------------------------------------------------------------------------------
+/// ワーカーで定数の設定を比べます。
+///
+/// 回ごとに、残っている設定とその回のステージの組を1つの仕事として、ワーカーが番号を取り合います。
+/// 定数は解答が thread_local に持つので、仕事ごとにワーカーのスレッドで設定を適用してから解きます。
+/// ステージは仕事ごとに生成し直すので、どの設定も同じ初期状態から解きます。
+///
+/// @param[in,out] aTuner 比べる設定。結果もここに記録します。
+/// @param[in] aThreadCount ワーカーの数。
+/// @param[in] aCorpus ステージコーパス。シード値からステージを生成するなら nullptr。
+template <class TRecorder, class TTimer>
+void BasicGame<TRecorder, TTimer>::runTuningWorkers(Tuner& aTuner, int aThreadCount, const StageCorpus* aCorpus)
+{
+    HPC_LB_ASSERT_I(aThreadCount, 0);
+
+    mTimer.start();
+
+    const int stageCount = aCorpus != nullptr ? aCorpus->stageCount() : Parameter::GameStageCount;
+    aTuner.start(stageCount);
+    const Random random = mRandom;
+    const int firstStageIndex = mStageIndex;
+
+    while (aTuner.nextRound()) {
+        const std::vector<int>& survivors = aTuner.survivors();
+        const int begin = aTuner.roundBegin();
+        const int taskCount = int(survivors.size()) * (aTuner.roundEnd() - begin);
+        std::atomic<int> nextTask(0);
+
+        auto work = [&]() {
+            Answer answer;
+            for (;;) {
+                const int task = nextTask.fetch_add(1);
+                if (task >= taskCount) {
+                    break;
+                }
+                const int i = begin + task / int(survivors.size());
+                const int c = survivors[task % int(survivors.size())];
+                aTuner.apply(c);
+
+                Stage stage(aCorpus == nullptr ? StageSeedAt(random, i) : RandomSeed::DefaultSeed());
+                if (aCorpus != nullptr) {
+                    aCorpus->initStage(i, stage);
+                } else {
+                    stage.init(mPlacementMode);
+                }
+
+                timespec beginTime, endTime;
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &beginTime);
+                StageContext::SetIndex(aCorpus == nullptr ? firstStageIndex + i : i);
+                PlayStage(answer, stage, nullptr);
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &endTime);
+                const double sec = double(endTime.tv_sec - beginTime.tv_sec) + double(endTime.tv_nsec - beginTime.tv_nsec) * 1e-9;
+                aTuner.setResult(c, i, stage.turn(), sec);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < aThreadCount; ++t) {
+            workers.push_back(std::thread(work));
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    if (aCorpus == nullptr) {
+        mRandom.jump(uint64_t(stageCount) * RandomCountPerStage);
+        mStageIndex += stageCount;
+    }
+
+    mTimer.stop();
+}
+
+//------------------------------------------------------------------------------
+// 使う組み合わせを実体化します。
+template class BasicGame<Recorder, Timer>;
+template class BasicGame<NullRecorder, Timer>;
+template class BasicGame<StreamingRecorder, Timer>;
+template class BasicGame<NullRecorder, NullTimer>;
+
 } // namespace
 // EOF
@@ -10,27 +10,75 @@
 #pragma once
 
 #include "Answer.hpp"
+#include "LowerBound.hpp"
+#include "NullRecorder.hpp"
+#include "PlanFile.hpp"
 #include "Recorder.hpp"
 #include "Random.hpp"
+#include "StageCorpus.hpp"
+#include "StreamingRecorder.hpp"
 #include "Timer.hpp"
+#include "Tournament.hpp"
+#include "Tuner.hpp"
 
 namespace hpc {
 
 //------------------------------------------------------------------------------
 /// ゲーム全体。
-class Game
+///
+/// ログ記録器とタイマーはテンプレート引数で選びます。呼び出しはインライン展開できるので、
+/// NullRecorder を選べばターンごとの記録の費用は掛かりません。
+///
+/// @tparam TRecorder ログ記録器。Recorder, NullRecorder, StreamingRecorder のいずれか。
+/// @tparam TTimer タイマー。Timer か NullTimer。
+///
+/// @note 関数の定義は Game.cpp にあり、使う組み合わせはそこで明示的に実体化します。
+template <class TRecorder, class TTimer>
+class BasicGame
 {
 public:
-    Game(RandomSeed aSeed);
+    BasicGame(RandomSeed aSeed);
+    static RandomSeed StageSeed(RandomSeed aSeed, int aStageIndex); ///< ステージのシード値を取得します。
     void changeSeed(RandomSeed aSeed);         ///< シード値を変更します。
+    void skipStages(int aStageCount);          ///< ステージを生成せずに読み飛ばします。
+    void changePlacementMode(PlacementMode aMode); ///< ステージ生成時の家の配置方法を変更します。
     void run(Answer& aAnswer);                 ///< ゲームを実行します。
-    const Recorder& recorder()const;           ///< ログ記録器を取得します。
-    const Timer& timer()const;                 ///< タイマーを取得します。
+    void run(Answer& aAnswer, const StageCorpus& aCorpus); ///< コーパスのステージでゲームを実行します。
+    void runParallel(int aThreadCount, bool aIsSilent); ///< ステージを並列に実行します。
+    void runParallel(int aThreadCount, bool aIsSilent, const StageCorpus& aCorpus); ///< コーパスのステージを並列に実行します。
+    void runTournament(const std::vector<const AnswerEntry*>& aEntries, int aThreadCount, Tournament& aResult); ///< 複数の解答を同じステージで実行します。
+    void runTournament(const std::vector<const AnswerEntry*>& aEntries, int aThreadCount, Tournament& aResult, const StageCorpus& aCorpus); ///< 複数の解答をコーパスのステージで実行します。
+    void runTuning(Tuner& aTuner, int aThreadCount); ///< 定数の設定を successive halving で比べます。
+    void runTuning(Tuner& aTuner, int aThreadCount, const StageCorpus& aCorpus); ///< 定数の設定をコーパスのステージで比べます。
+    bool writeCorpus(const char* aPath, int aStageCount);  ///< ステージを生成してコーパスに書き出します。
+    void computeBounds(std::vector<StageBound>& aBounds, const StageCorpus* aCorpus)const; ///< run() が実行するステージの下界を求めます。
+    void replay(PlanReader& aReader, PlanVerification& aResult); ///< 解答を使わずにプランを再生します。
+    void changePlanWriter(PlanWriter* aWriter);   ///< run() の解答を記録するプランの書き出し先を変更します。
+    const TRecorder& recorder()const;          ///< ログ記録器を取得します。
+    const TTimer& timer()const;                ///< タイマーを取得します。
 private:
+    static const int RandomCountPerStage = 4;  ///< 1ステージのシード値で消費する乱数の数
+    static RandomSeed NextStageSeed(Random& aRandom); ///< 乱数生成器から次のステージのシード値を取得します。
+    static RandomSeed StageSeedAt(const Random& aRandom, int aStageIndex); ///< 乱数生成器から aStageIndex 個先のステージのシード値を取得します。
+    template <class TAnswer>
+    static void PlayStage(TAnswer& aAnswer, Stage& aStage, PlanStage* aPlan); ///< 記録せずにステージを実行します。
+    void runStage(Answer& aAnswer, Stage& aStage); ///< 初期化済みのステージを実行します。
+    void runWorkers(int aThreadCount, bool aIsSilent, const StageCorpus* aCorpus); ///< ワーカーでステージを並列に実行します。
+    void runTournamentWorkers(const std::vector<const AnswerEntry*>& aEntries, int aThreadCount, Tournament& aResult, const StageCorpus* aCorpus); ///< ワーカーで複数の解答を実行します。
+    void runTuningWorkers(Tuner& aTuner, int aThreadCount, const StageCorpus* aCorpus); ///< ワーカーで定数の設定を比べます。
+
     Random mRandom;                            ///< 乱数生成器
-    Recorder mRecorder;                        ///< ログ記録器
-    Timer mTimer;                              ///< タイマー
+    int mStageIndex;                           ///< mRandom が次に生成するステージの番号 (-k で読み飛ばした分も数える)
+    PlacementMode mPlacementMode;              ///< 家の配置方法
+    PlanWriter* mPlanWriter;                   ///< プランの書き出し先 (記録しなければ nullptr)
+    TRecorder mRecorder;                       ///< ログ記録器
+    TTimer mTimer;                             ///< タイマー
 };
 
+typedef BasicGame<Recorder, Timer> Game;                    ///< 全ターンを記録するゲーム。Json を出力できます。
+typedef BasicGame<NullRecorder, Timer> TurnCountGame;       ///< ステージのターン数だけを記録するゲーム。
+typedef BasicGame<StreamingRecorder, Timer> StreamingGame;  ///< ステージごとにログを書き出すゲーム。
+typedef BasicGame<NullRecorder, NullTimer> BenchGame;       ///< 記録も計測もしないゲーム。ベンチマーク用。
+
 } // namespace
 // EOF
@@ -0,0 +1,314 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+#include "Array.hpp"
+#include "Parameter.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// 家の番号の集合。
+///
+/// 128 ビットの固定長のビット集合です。要素数や集合演算は数語の演算で済みます。
+/// 範囲 for で、番号の小さい順に要素を列挙できます。
+/// 番号の範囲は Array と同じく ArrayDefaultPolicy で検査します。
+class HouseSet
+{
+public:
+    static const int WordBitCount = 64;                     ///< 1語のビット数
+    static const int WordCount = 2;                         ///< 語の数
+    static const int Capacity = WordBitCount * WordCount;   ///< 入れられる番号の上限 (含まない)
+
+    /// 要素を番号の小さい順に列挙するイテレータ。
+    class Iterator
+    {
+    public:
+        inline Iterator(const HouseSet& aSet, int aWord);
+        inline int operator*() const;
+        inline Iterator& operator++();
+        inline bool operator!=(const Iterator& aOther) const;
+    private:
+        inline void skipEmptyWords();
+
+        const HouseSet* mSet;
+        int mWord;                                          ///< 今の語の添字
+        uint64_t mRest;                                     ///< 今の語の、まだ列挙していないビット
+    };
+
+    /// 空の集合を生成します。
+    inline HouseSet();
+
+    /// [0, aCount) の番号の集合を取得します。
+    inline static HouseSet Range(int aCount);
+
+    /// @name 要素を操作します。
+    //@{
+    inline bool contains(int aIndex) const;
+    inline void add(int aIndex);
+    inline void remove(int aIndex);
+    inline void clear();
+    //@}
+
+    /// 要素数を取得します。
+    inline int count() const;
+
+    /// 空かどうかを取得します。
+    inline bool isEmpty() const;
+
+    /// 番号の小さい順で aOrder 番目 (0 始まり) の要素を取得します。なければ -1。
+    inline int nth(int aOrder) const;
+
+    /// 共通の要素があるかを取得します。
+    inline bool intersects(const HouseSet& aOther) const;
+
+    /// @name 集合演算です。- は差集合です。
+    //@{
+    inline HouseSet& operator&=(const HouseSet& aOther);
+    inline HouseSet& operator|=(const HouseSet& aOther);
+    inline HouseSet& operator-=(const HouseSet& aOther);
+    inline HouseSet operator&(const HouseSet& aOther) const;
+    inline HouseSet operator|(const HouseSet& aOther) const;
+    inline HouseSet operator-(const HouseSet& aOther) const;
+    inline bool operator==(const HouseSet& aOther) const;
+    inline bool operator!=(const HouseSet& aOther) const;
+    //@}
+
+    /// @name イテレータを返します。
+    //@{
+    inline Iterator begin() const;
+    inline Iterator end() const;
+    //@}
+
+private:
+    static_assert(Parameter::MaxHouseCount <= WordBitCount * WordCount, "too many houses for HouseSet");
+
+    uint64_t mWords[WordCount];
+};
+
+//------------------------------------------------------------------------------
+HouseSet::Iterator::Iterator(const HouseSet& aSet, int aWord)
+: mSet(&aSet)
+, mWord(aWord)
+, mRest(aWord < WordCount ? aSet.mWords[aWord] : 0)
+{
+    skipEmptyWords();
+}
+
+//------------------------------------------------------------------------------
+int HouseSet::Iterator::operator*() const
+{
+    return mWord * WordBitCount + __builtin_ctzll(mRest);
+}
+
+//------------------------------------------------------------------------------
+HouseSet::Iterator& HouseSet::Iterator::operator++()
+{
+    // 一番下の立っているビットを落とす
+    mRest &= mRest - 1;
+    skipEmptyWords();
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+bool HouseSet::Iterator::operator!=(const Iterator& aOther) const
+{
+    return mWord != aOther.mWord || mRest != aOther.mRest;
+}
+
+//------------------------------------------------------------------------------
+void HouseSet::Iterator::skipEmptyWords()
+{
+    while (mRest == 0 && mWord < WordCount) {
+        ++mWord;
+        mRest = mWord < WordCount ? mSet->mWords[mWord] : 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+HouseSet::HouseSet()
+: mWords()
+{
+}
+
+//------------------------------------------------------------------------------
+HouseSet HouseSet::Range(int aCount)
+{
+    HPC_RANGE_ASSERT_MIN_MAX_I(aCount, 0, Capacity);
+    HouseSet result;
+    for (int i = 0; i < WordCount; ++i) {
+        const int bitCount = aCount - i * WordBitCount;
+        if (bitCount >= WordBitCount) {
+            result.mWords[i] = ~uint64_t(0);
+        } else if (bitCount > 0) {
+            result.mWords[i] = (uint64_t(1) << bitCount) - 1;
+        }
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+bool HouseSet::contains(int aIndex) const
+{
+    ArrayDefaultPolicy::CheckIndex(aIndex, Capacity);
+    return (mWords[aIndex / WordBitCount] >> (aIndex % WordBitCount)) & 1;
+}
+
+//------------------------------------------------------------------------------
+void HouseSet::add(int aIndex)
+{
+    ArrayDefaultPolicy::CheckIndex(aIndex, Capacity);
+    mWords[aIndex / WordBitCount] |= uint64_t(1) << (aIndex % WordBitCount);
+}
+
+//------------------------------------------------------------------------------
+void HouseSet::remove(int aIndex)
+{
+    ArrayDefaultPolicy::CheckIndex(aIndex, Capacity);
+    mWords[aIndex / WordBitCount] &= ~(uint64_t(1) << (aIndex % WordBitCount));
+}
+
+//------------------------------------------------------------------------------
+void HouseSet::clear()
+{
+    for (int i = 0; i < WordCount; ++i) {
+        mWords[i] = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+int HouseSet::count() const
+{
+    int result = 0;
+    for (int i = 0; i < WordCount; ++i) {
+        result += __builtin_popcountll(mWords[i]);
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+bool HouseSet::isEmpty() const
+{
+    uint64_t any = 0;
+    for (int i = 0; i < WordCount; ++i) {
+        any |= mWords[i];
+    }
+    return any == 0;
+}
+
+//------------------------------------------------------------------------------
+int HouseSet::nth(int aOrder) const
+{
+    // 語ごとの要素数で飛ばしてから、語の中を数える
+    for (int i = 0; i < WordCount; ++i) {
+        const int wordCount = __builtin_popcountll(mWords[i]);
+        if (aOrder < wordCount) {
+            uint64_t rest = mWords[i];
+            for (; aOrder > 0; --aOrder) {
+                rest &= rest - 1;
+            }
+            return i * WordBitCount + __builtin_ctzll(rest);
+        }
+        aOrder -= wordCount;
+    }
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+bool HouseSet::intersects(const HouseSet& aOther) const
+{
+    uint64_t any = 0;
+    for (int i = 0; i < WordCount; ++i) {
+        any |= mWords[i] & aOther.mWords[i];
+    }
+    return any != 0;
+}
+
+//------------------------------------------------------------------------------
+HouseSet& HouseSet::operator&=(const HouseSet& aOther)
+{
+    for (int i = 0; i < WordCount; ++i) {
+        mWords[i] &= aOther.mWords[i];
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+HouseSet& HouseSet::operator|=(const HouseSet& aOther)
+{
+    for (int i = 0; i < WordCount; ++i) {
+        mWords[i] |= aOther.mWords[i];
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+HouseSet& HouseSet::operator-=(const HouseSet& aOther)
+{
+    for (int i = 0; i < WordCount; ++i) {
+        mWords[i] &= ~aOther.mWords[i];
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+HouseSet HouseSet::operator&(const HouseSet& aOther) const
+{
+    HouseSet result = *this;
+    return result &= aOther;
+}
+
+//------------------------------------------------------------------------------
+HouseSet HouseSet::operator|(const HouseSet& aOther) const
+{
+    HouseSet result = *this;
+    return result |= aOther;
+}
+
+//------------------------------------------------------------------------------
+HouseSet HouseSet::operator-(const HouseSet& aOther) const
+{
+    HouseSet result = *this;
+    return result -= aOther;
+}
+
+//------------------------------------------------------------------------------
+bool HouseSet::operator==(const HouseSet& aOther) const
+{
+    for (int i = 0; i < WordCount; ++i) {
+        if (mWords[i] != aOther.mWords[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool HouseSet::operator!=(const HouseSet& aOther) const
+{
+    return !(*this == aOther);
+}
+
+//------------------------------------------------------------------------------
+HouseSet::Iterator HouseSet::begin() const
+{
+    return Iterator(*this, 0);
+}
+
+//------------------------------------------------------------------------------
+HouseSet::Iterator HouseSet::end() const
+{
+    return Iterator(*this, WordCount);
+}
+
+} // namespace
+// EOF
@@ -0,0 +1,185 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "LowerBound.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+#include "Assert.hpp"
+
+namespace hpc {
+
+namespace {
+
+//------------------------------------------------------------------------------
+/// 隙間を詰めるのに要する移動のターン数を求めます。
+///
+/// 浮動小数の誤差で下界を超えないよう、少しだけ切り捨て側に寄せます。
+int MoveTurns(float aGap, float aSpeed)
+{
+    return aGap <= 0.0f ? 0 : int(std::ceil(aGap / aSpeed - 1e-3f));
+}
+
+//------------------------------------------------------------------------------
+/// 農場から出たUFOが家に届けられる最初のターン数を求めます。
+///
+/// 1ターン目の受け渡しフェーズで積み込み、移動して家に触れた次のターンの受け渡しフェーズで配ります。
+int DeliverTurn(float aDist, float aRadius, float aSpeed)
+{
+    return MoveTurns(aDist - aRadius - Parameter::HouseRadius, aSpeed) + 1;
+}
+
+int SmallDeliverTurn(float aDist)
+{
+    return DeliverTurn(aDist, Parameter::SmallUFORadius, Parameter::SmallUFOMaxSpeed);
+}
+
+int LargeDeliverTurn(float aDist)
+{
+    return DeliverTurn(aDist, Parameter::LargeUFORadius, Parameter::LargeUFOMaxSpeed);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/// 最も強い下界を取得します。
+int StageBound::best()const
+{
+    return std::max(farthest, std::max(trips, tree));
+}
+
+//------------------------------------------------------------------------------
+/// 全ての下界を求めます。
+///
+/// @param[in] aStage 開始直後のステージ。
+StageBound LowerBound::Compute(const Stage& aStage)
+{
+    StageBound bound;
+    bound.farthest = Farthest(aStage);
+    bound.trips = Trips(aStage);
+    bound.tree = Tree(aStage);
+    return bound;
+}
+
+//------------------------------------------------------------------------------
+/// 最も遠い家に届けるまでのターン数を求めます。
+///
+/// UFOは全て農場の真上から出発するので、家ごとに速い方のUFOが直接向かった場合のターン数の最大値です。
+///
+/// @param[in] aStage 開始直後のステージ。
+int LowerBound::Farthest(const Stage& aStage)
+{
+    HPC_ASSERT(aStage.turn() == 0);
+    const Vector2 office = aStage.office().pos();
+    int bound = 0;
+    for (int i = 0; i < aStage.houses().count(); ++i) {
+        const float dist = office.dist(aStage.houses()[i].pos());
+        bound = std::max(bound, std::min(SmallDeliverTurn(dist), LargeDeliverTurn(dist)));
+    }
+    return bound;
+}
+
+//------------------------------------------------------------------------------
+/// 小さいUFOの積み荷の数から下界を求めます。
+///
+/// 最初の配達より前に小さいUFOが持てる箱は、全部で SmallUFOCount * SmallUFOCapacity 個です。
+/// それ以外の家には、大きいUFOが自分で届けるか、最初の配達以降に補給した小さいUFOが届けることになります。
+/// 補給は農場か大きいUFOに触れて行うので、その時点の補給場所は農場から大きいUFOが進める距離の内にあります。
+/// 遅い方の手段でしか届けられない家が多ければ、そのうち最も早いものでも下界になります。
+///
+/// @note 小さいUFOどうしの受け渡しは数えていません。箱を中継すると補給場所が遠くなり得るためです。
+///
+/// @param[in] aStage 開始直後のステージ。
+int LowerBound::Trips(const Stage& aStage)
+{
+    HPC_ASSERT(aStage.turn() == 0);
+    const int houseCount = aStage.houses().count();
+    const int firstLoad = Parameter::SmallUFOCount * Parameter::SmallUFOCapacity;
+    if (houseCount <= firstLoad) {
+        return 0;
+    }
+
+    const Vector2 office = aStage.office().pos();
+    std::vector<float> dists(houseCount);
+    int firstDeliverTurn = Parameter::GameTurnLimit;
+    for (int i = 0; i < houseCount; ++i) {
+        dists[i] = office.dist(aStage.houses()[i].pos());
+        firstDeliverTurn = std::min(firstDeliverTurn, std::min(SmallDeliverTurn(dists[i]), LargeDeliverTurn(dists[i])));
+    }
+
+    // 最初の配達のターンに補給する場合が最も早い。補給が遅いほど、大きいUFOの進む距離より時間の方が掛かる
+    const float refillReach = std::max(
+        float(Parameter::OfficeRadius + Parameter::SmallUFORadius),
+        float(Parameter::LargeUFOMaxSpeed * (firstDeliverTurn - 1) + Parameter::LargeUFORadius + Parameter::SmallUFORadius));
+    std::vector<int> slowTurns(houseCount);
+    for (int i = 0; i < houseCount; ++i) {
+        const int refilled = firstDeliverTurn + MoveTurns(dists[i] - Parameter::SmallUFORadius - Parameter::HouseRadius - refillReach, Parameter::SmallUFOMaxSpeed);
+        slowTurns[i] = std::min(LargeDeliverTurn(dists[i]), refilled);
+    }
+
+    // 遅い手段の掛かる家から順に、最初の積み荷を割り当てる
+    std::nth_element(slowTurns.begin(), slowTurns.begin() + firstLoad, slowTurns.end(), std::greater<int>());
+    return slowTurns[firstLoad];
+}
+
+//------------------------------------------------------------------------------
+/// 最小全域木から下界を求めます。
+///
+/// 全UFOの軌跡は農場の中心でつながっていて、各家から UFO と家の半径の和以内を通ります。
+/// 軌跡に家への線分を足したものは農場と全ての家をつなぐので、その長さは最小シュタイナー木以上で、
+/// 最小シュタイナー木は最小全域木の 1/2 倍以上です。
+/// (√3/2 倍以上という Gilbert-Pollak 予想は証明されていないので、使いません。)
+/// 1ターンに全UFOが進める距離の合計で割ると、配達に要する移動のターン数の下界になります。
+///
+/// @param[in] aStage 開始直後のステージ。
+int LowerBound::Tree(const Stage& aStage)
+{
+    HPC_ASSERT(aStage.turn() == 0);
+    const int houseCount = aStage.houses().count();
+    if (houseCount == 0) {
+        return 0;
+    }
+
+    // 農場から始める Prim 法
+    std::vector<Vector2> points(houseCount);
+    std::vector<float> nearest(houseCount);
+    std::vector<bool> isConnected(houseCount, false);
+    for (int i = 0; i < houseCount; ++i) {
+        points[i] = aStage.houses()[i].pos();
+        nearest[i] = aStage.office().pos().dist(points[i]);
+    }
+    float treeLength = 0.0f;
+    for (int n = 0; n < houseCount; ++n) {
+        int next = -1;
+        for (int i = 0; i < houseCount; ++i) {
+            if (!isConnected[i] && (next < 0 || nearest[i] < nearest[next])) {
+                next = i;
+            }
+        }
+        isConnected[next] = true;
+        treeLength += nearest[next];
+        for (int i = 0; i < houseCount; ++i) {
+            if (!isConnected[i]) {
+                nearest[i] = std::min(nearest[i], points[next].dist(points[i]));
+            }
+        }
+    }
+
+    const float spokes = float(houseCount * (Parameter::LargeUFORadius + Parameter::HouseRadius));
+    const float speedSum = float(
+        Parameter::LargeUFOCount * Parameter::LargeUFOMaxSpeed +
+        Parameter::SmallUFOCount * Parameter::SmallUFOMaxSpeed);
+    return MoveTurns(treeLength / 2.0f - spokes, speedSum) + 1;
+}
+
+} // namespace
+// EOF
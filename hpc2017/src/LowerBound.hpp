@@ -0,0 +1,45 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include "Stage.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// ステージのターン数の下界。
+///
+/// どれも、開始直後のステージだけから求められる値です。
+struct StageBound
+{
+    int farthest;   ///< 最も遠い家に届けるまでのターン数
+    int trips;      ///< 小さいUFOの最初の積み荷で配れる数から求めたターン数
+    int tree;       ///< 全UFOの移動距離と最小全域木から求めたターン数
+
+    int best()const;    ///< 最も強い下界を取得します。
+};
+
+//------------------------------------------------------------------------------
+/// ステージのターン数の下界を求める関数群。
+///
+/// 解答によらず、どのような行動を取ってもこれより少ないターン数では終わりません。
+/// 結果の、下界との差を見ることで、改善の余地が大きいステージを探せます。
+class LowerBound
+{
+public:
+    static StageBound Compute(const Stage& aStage); ///< 全ての下界を求めます。
+    static int Farthest(const Stage& aStage);       ///< 最も遠い家に届けるまでのターン数を求めます。
+    static int Trips(const Stage& aStage);          ///< 小さいUFOの積み荷の数から下界を求めます。
+    static int Tree(const Stage& aStage);           ///< 最小全域木から下界を求めます。
+};
+
+} // namespace
+// EOF
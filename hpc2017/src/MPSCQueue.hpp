@@ -0,0 +1,128 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// 要素数に上限のある、ロックを使わない複数生産者・単一消費者キュー。
+///
+/// - 各セルが次に受け付ける位置 (sequence) を持ち、生産者は書き込む位置を CAS で確保します。
+///   消費者は1人だけなので、取り出す位置は消費者だけが持ちます。
+/// - 満杯や空のときは待たずに false を返します。待ち方は呼び出し側が決めてください。
+/// - TCapacity は 2 の累乗にしてください。
+template <typename TElement, int TCapacity>
+class MPSCQueue
+{
+    static_assert(TCapacity >= 2 && (TCapacity & (TCapacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    /// コンストラクタ。
+    inline MPSCQueue();
+
+    /// 要素を末尾に追加します。どのスレッドからも呼び出せます。
+    ///
+    /// @return 満杯なら追加せずに false を返します。
+    inline bool tryPush(const TElement& aData);
+
+    /// 先頭の要素を取り出します。消費者のスレッドだけが呼び出せます。
+    ///
+    /// @return 空なら false を返します。
+    inline bool tryPop(TElement& aData);
+
+    /// 格納可能な最大要素数を取得します。
+    inline int maxCount() const;
+
+private:
+    MPSCQueue(const MPSCQueue&);
+    MPSCQueue& operator=(const MPSCQueue&);
+
+    struct Cell
+    {
+        std::atomic<uint64_t> sequence;     ///< このセルが受け付ける位置
+        TElement data;
+    };
+    static const uint64_t Mask = TCapacity - 1;
+
+    Cell mCells[TCapacity];
+    alignas(64) std::atomic<uint64_t> mPushPos; ///< 次に書き込む位置 (生産者が共有)
+    alignas(64) uint64_t mPopPos;               ///< 次に取り出す位置 (消費者だけが使う)
+};
+
+//------------------------------------------------------------------------------
+template <typename TElement, int TCapacity>
+MPSCQueue<TElement, TCapacity>::MPSCQueue()
+: mCells()
+, mPushPos(0)
+, mPopPos(0)
+{
+    for (int i = 0; i < TCapacity; ++i) {
+        mCells[i].sequence.store(uint64_t(i), std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+template <typename TElement, int TCapacity>
+bool MPSCQueue<TElement, TCapacity>::tryPush(const TElement& aData)
+{
+    uint64_t pos = mPushPos.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+        cell = &mCells[pos & Mask];
+        const uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const int64_t diff = int64_t(sequence - pos);
+        if (diff == 0) {
+            // 空いているセルなので、位置の確保を試みる
+            if (mPushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 消費者がまだ取り出していない = 満杯
+            return false;
+        } else {
+            // 他の生産者に先を越された
+            pos = mPushPos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->data = aData;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template <typename TElement, int TCapacity>
+bool MPSCQueue<TElement, TCapacity>::tryPop(TElement& aData)
+{
+    Cell& cell = mCells[mPopPos & Mask];
+    const uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if (int64_t(sequence - (mPopPos + 1)) < 0) {
+        return false;
+    }
+
+    aData = cell.data;
+    cell.sequence.store(mPopPos + TCapacity, std::memory_order_release);
+    ++mPopPos;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template <typename TElement, int TCapacity>
+int MPSCQueue<TElement, TCapacity>::maxCount() const
+{
+    return TCapacity;
+}
+
+} // namespace
+// EOF
@@ -7,11 +7,16 @@
 ///             利用条件に従ってください。
 //------------------------------------------------------------------------------
 
+#include "AllocTracker.hpp"
+#include "AnswerRegistry.hpp"
 #include "Print.hpp"
 #include "Simulator.hpp"
+#include "Stats.hpp"
+#include "Tunable.hpp"
 
 #include <cstring>
 #include <cstdlib>
+#include <vector>
 
 //------------------------------------------------------------------------------
 namespace {
@@ -25,13 +30,30 @@ namespace {
 int main(int argc, const char* argv[])
 {
     bool willPrintJson = false;
+    bool willStreamJson = false;
     bool silentMode = false;
+    bool willPrintStats = false;
+    bool willPrintAlloc = false;
+    bool willPrintGap = false;
+    const char* corpusPath = nullptr;
+    const char* generatePath = nullptr;
+    int generateCount = 0;
+    int firstStage = 0;
+    int threadCount = 0;
+    const char* planPath = nullptr;
+    const char* verifyPath = nullptr;
+    const char* answerNames = nullptr;
+    bool willTune = false;
+    int tuneCount = 0;
+    std::vector<const char*> sweeps;
 
     if (argc > 1) {
         for (int n = 1; n < argc; ++n) {
             // 引数がある場合、引数を記憶します。
             if (!std::strcmp(argv[n], "-j")) {
                 willPrintJson = true;
+            } else if (!std::strcmp(argv[n], "-jl")) {
+                willStreamJson = true;
             } else if (!std::strcmp(argv[n], "-r")) {
                 if (n + 4 < argc) {
                     hpc::RandomSeed seed = hpc::RandomSeed::DefaultSeed();
@@ -53,6 +75,118 @@ int main(int argc, const char* argv[])
                 }
             } else if (!std::strcmp(argv[n], "-s")) {
                 silentMode = true;
+            } else if (!std::strcmp(argv[n], "-stats")) {
+                willPrintStats = true;
+            } else if (!std::strcmp(argv[n], "-alloc")) {
+                willPrintAlloc = true;
+            } else if (!std::strcmp(argv[n], "-gap")) {
+                willPrintGap = true;
+            } else if (!std::strcmp(argv[n], "-k")) {
+                if (n + 1 < argc) {
+                    firstStage = int(std::strtol(argv[n + 1], nullptr, 0));
+
+                    if (firstStage < 0) {
+                        HPC_PRINTF("Invalid Argument.(-k) first stage must not be negative.\n");
+                        return 1;
+                    }
+
+                    n += 1;
+                } else {
+                    HPC_PRINTF("Invalid Argument.(-k) need a first stage number.\n");
+                    return 1;
+                }
+            } else if (!std::strcmp(argv[n], "-t")) {
+                if (n + 1 < argc) {
+                    threadCount = int(std::strtol(argv[n + 1], nullptr, 0));
+                    if (threadCount <= 0) {
+                        HPC_PRINTF("Invalid Argument.(-t) thread count must be positive.\n");
+                        return 1;
+                    }
+                    n += 1;
+                } else {
+                    HPC_PRINTF("Invalid Argument.(-t) need a thread count.\n");
+                    return 1;
+                }
+            } else if (!std::strcmp(argv[n], "-a")) {
+                if (n + 1 < argc) {
+                    answerNames = argv[n + 1];
+                    n += 1;
+                } else {
+                    HPC_PRINTF("Invalid Argument.(-a) need answer names separated by ','.\n");
+                    return 1;
+                }
+            } else if (!std::strcmp(argv[n], "-tune")) {
+                if (n + 1 < argc) {
+                    tuneCount = int(std::strtol(argv[n + 1], nullptr, 0));
+                    if (tuneCount < 0) {
+                        HPC_PRINTF("Invalid Argument.(-tune) config count must not be negative.\n");
+                        return 1;
+                    }
+                    willTune = true;
+                    n += 1;
+                } else {
+                    HPC_PRINTF("Invalid Argument.(-tune) need a config count.\n");
+                    return 1;
+                }
+            } else if (!std::strcmp(argv[n], "-sweep")) {
+                if (n + 1 < argc) {
+                    sweeps.push_back(argv[n + 1]);
+                    willTune = true;
+                    n += 1;
+                } else {
+                    HPC_PRINTF("Invalid Argument.(-sweep) need name=value,value,...\n");
+                    return 1;
+                }
+            } else if (!std::strcmp(argv[n], "-p")) {
+                if (n + 1 < argc && !std::strcmp(argv[n + 1], "legacy")) {
+                    sSim.changePlacementMode(hpc::PlacementMode_Legacy);
+                    n += 1;
+                } else if (n + 1 < argc && !std::strcmp(argv[n + 1], "freecell")) {
+                    sSim.changePlacementMode(hpc::PlacementMode_FreeCell);
+                    n += 1;
+                } else {
+                    HPC_PRINTF("Invalid Argument.(-p) need legacy or freecell.\n");
+                    return 1;
+                }
+            } else if (!std::strcmp(argv[n], "-w")) {
+                if (n + 1 < argc) {
+                    planPath = argv[n + 1];
+                    n += 1;
+                } else {
+                    HPC_PRINTF("Invalid Argument.(-w) need a plan file.\n");
+                    return 1;
+                }
+            } else if (!std::strcmp(argv[n], "-v")) {
+                if (n + 1 < argc) {
+                    verifyPath = argv[n + 1];
+                    n += 1;
+                } else {
+                    HPC_PRINTF("Invalid Argument.(-v) need a plan file.\n");
+                    return 1;
+                }
+            } else if (!std::strcmp(argv[n], "-c")) {
+                if (n + 1 < argc) {
+                    corpusPath = argv[n + 1];
+                    n += 1;
+                } else {
+                    HPC_PRINTF("Invalid Argument.(-c) need a corpus file.\n");
+                    return 1;
+                }
+            } else if (!std::strcmp(argv[n], "-g")) {
+                if (n + 2 < argc) {
+                    generatePath = argv[n + 1];
+                    generateCount = int(std::strtol(argv[n + 2], nullptr, 0));
+
+                    if (generateCount <= 0) {
+                        HPC_PRINTF("Invalid Argument.(-g) stage count must be positive.\n");
+                        return 1;
+                    }
+
+                    n += 2;
+                } else {
+                    HPC_PRINTF("Invalid Argument.(-g) need a corpus file and a stage count.\n");
+                    return 1;
+                }
             } else {
                 // 不明な引数
                 HPC_PRINTF("Invalid Argument.(%s)\n", argv[n]);
@@ -61,14 +195,165 @@ int main(int argc, const char* argv[])
         }
     }
 
-    sSim.run();
+    if (willPrintJson && willStreamJson) {
+        HPC_PRINTF("Invalid Argument.(-jl) can't be used with -j.\n");
+        return 1;
+    }
+    if (willStreamJson && (willPrintStats || threadCount > 0 || verifyPath != nullptr)) {
+        // ログは実行中に1ステージずつ標準出力へ書き出す
+        HPC_PRINTF("Invalid Argument.(-jl) can't be used with -stats, -t or -v.\n");
+        return 1;
+    }
+    if (willPrintJson && willPrintStats) {
+        HPC_PRINTF("Invalid Argument.(-stats) can't print stats with json.\n");
+        return 1;
+    }
+    if (threadCount > 0 && willPrintJson) {
+        // 並列実行ではターンごとの記録を残さない
+        HPC_PRINTF("Invalid Argument.(-t) can't print json.\n");
+        return 1;
+    }
+    if (threadCount > 0 && willPrintStats) {
+        // 統計はスレッドごとに記録される
+        HPC_PRINTF("Invalid Argument.(-t) can't print stats.\n");
+        return 1;
+    }
+
+    if (willPrintAlloc && (willPrintJson || willStreamJson || threadCount > 0 || answerNames != nullptr || verifyPath != nullptr)) {
+        // 確保はスレッドごとに、ゲームを1つずつ実行したときだけ記録される
+        HPC_PRINTF("Invalid Argument.(-alloc) can't be used with -j, -jl, -t, -a or -v.\n");
+        return 1;
+    }
+
+    if (willPrintGap && (willPrintJson || willStreamJson || answerNames != nullptr || verifyPath != nullptr)) {
+        // 下界と比べるのは、ステージごとのターン数だけを記録した結果
+        HPC_PRINTF("Invalid Argument.(-gap) can't be used with -j, -jl, -a or -v.\n");
+        return 1;
+    }
+
+    if (answerNames != nullptr && (willPrintJson || willStreamJson || willPrintStats || planPath != nullptr || verifyPath != nullptr)) {
+        // 複数の解答を実行するときは、ターン数と時間だけを記録する
+        HPC_PRINTF("Invalid Argument.(-a) can't be used with -j, -jl, -stats, -w or -v.\n");
+        return 1;
+    }
+
+    if (willTune && (willPrintJson || willStreamJson || willPrintStats || willPrintAlloc || willPrintGap
+        || answerNames != nullptr || planPath != nullptr || verifyPath != nullptr)) {
+        // 設定を比べるときは、ターン数と時間だけを記録する
+        HPC_PRINTF("Invalid Argument.(-tune) can't be used with -j, -jl, -stats, -alloc, -gap, -a, -w or -v.\n");
+        return 1;
+    }
+
+    // シード値が決まってから読み飛ばす
+    sSim.skipStages(firstStage);
+
+    if (generatePath != nullptr) {
+        // シード値からステージを生成してコーパスに書き出し、終了します。
+        if (!sSim.writeCorpus(generatePath, generateCount)) {
+            HPC_PRINTF("Failed to write corpus.(%s)\n", generatePath);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (verifyPath != nullptr) {
+        // 解答を実行せず、プランを再生して結果を出力します。
+        if (!sSim.verifyPlan(verifyPath)) {
+            HPC_PRINTF("Invalid Argument.(-v) can't open plan file.(%s)\n", verifyPath);
+            return 1;
+        }
+        sSim.printResult(silentMode);
+        if (willPrintStats) {
+            hpc::Stats::Instance().print();
+        }
+        return 0;
+    }
+
+    if (corpusPath != nullptr && !sSim.openCorpus(corpusPath)) {
+        HPC_PRINTF("Invalid Argument.(-c) can't open corpus file.(%s)\n", corpusPath);
+        return 1;
+    }
+
+    if (answerNames != nullptr) {
+        // 登録された解答を同じステージで実行し、基準の解答と比べます。
+        if (!sSim.runTournament(answerNames, threadCount > 0 ? threadCount : 1)) {
+            HPC_PRINTF("Invalid Argument.(-a) unknown answer name.(%s)\n", answerNames);
+            const hpc::AnswerRegistry& registry = hpc::AnswerRegistry::Instance();
+            for (int i = 0; i < registry.count(); ++i) {
+                HPC_PRINTF("  %s\n", registry.entry(i).name);
+            }
+            return 1;
+        }
+        sSim.printResult(silentMode);
+        return 0;
+    }
+
+    if (willTune) {
+        // 解答の定数を既定値と変えて同じステージで実行し、良い設定を残しながら比べます。
+        if (!sSim.runTuning(tuneCount, sweeps, threadCount > 0 ? threadCount : 1)) {
+            HPC_PRINTF("Invalid Argument.(-sweep) unknown name or bad values.\n");
+            const hpc::TunableRegistry& registry = hpc::TunableRegistry::Instance();
+            for (int i = 0; i < registry.count(); ++i) {
+                const hpc::TunableEntry& entry = registry.entry(i);
+                HPC_PRINTF("  %s (default %g, range %g .. %g)\n", entry.name, entry.defaultValue, entry.minValue, entry.maxValue);
+            }
+            return 1;
+        }
+        sSim.printResult(silentMode);
+        return 0;
+    }
+
+    if (planPath != nullptr) {
+        if (corpusPath != nullptr) {
+            HPC_PRINTF("Invalid Argument.(-w) can't record a plan for corpus stages.\n");
+            return 1;
+        }
+        if (!sSim.recordPlan(planPath)) {
+            HPC_PRINTF("Invalid Argument.(-w) can't create plan file.(%s)\n", planPath);
+            return 1;
+        }
+    }
+
+    if (willPrintJson) {
+        // Json の出力には全ターンの記録が要る
+        sSim.changeRecordMode(hpc::RecordMode_Full);
+    } else if (willStreamJson) {
+        sSim.changeRecordMode(hpc::RecordMode_Stream);
+    }
+
+    if (willPrintGap) {
+        // 実行で乱数生成器が進む前に求める
+        sSim.computeBounds();
+    }
+
+    if (threadCount > 0) {
+        sSim.runParallel(threadCount, silentMode);
+    } else {
+        sSim.run();
+    }
+
+    if (planPath != nullptr && !sSim.closePlan()) {
+        HPC_PRINTF("Failed to write plan.(%s)\n", planPath);
+        return 1;
+    }
 
     if(willPrintJson) {
         // Jsonを出力します。
         sSim.printJson();
+    } else if (willStreamJson) {
+        // ログは実行中に出力済みです。
     } else {
         // 通常の出力を行います。
         sSim.printResult(silentMode);
+        if (willPrintStats) {
+            hpc::Stats::Instance().print();
+        }
+        if (willPrintAlloc) {
+            hpc::AllocTracker::Instance().print(silentMode);
+        }
+        if (willPrintGap) {
+            sSim.printGap(silentMode);
+        }
     }
 
     return 0;
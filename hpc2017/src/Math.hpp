@@ -9,6 +9,11 @@
 
 #pragma once
 
+#include "Assert.hpp"
+
+#include <cmath>
+#include <limits>
+
 namespace hpc {
 
 //------------------------------------------------------------------------------
@@ -16,41 +21,272 @@ namespace hpc {
 ///
 /// このクラスは、 Answer.hpp からインクルードされているため、
 /// 参加者が利用することができます。
+///
+/// どの翻訳単位からもインライン展開できるよう、全ての関数をヘッダに定義しています。
 class Math {
 public:
-    static const float PI;                                          ///< 円周率
+    static constexpr float PI = 3.14159265359f; ///< 円周率
 
     ///@name 数値関係
     //@{
-    static bool IsEqualLoose(float aLhs, float aRhs);               ///< 二値が等しいかを誤差の範囲で判定します。
-    static float Max(float aLhs, float aRhs);                       ///< 二値のうち大きい方を返します。
-    static int Max(int aLhs, int aRhs);                             ///< 二値のうち大きい方を返します。
-    static float Min(float aLhs, float aRhs);                       ///< 二値のうち小さい方を返します。
-    static int Min(int aLhs, int aRhs);                             ///< 二値のうち小さい方を返します。
-    static float LimitMinMax(float aValue, float aMin, float aMax); ///< 値を指定の範囲 [min, max] に制限します。
-    static int LimitMinMax(int aValue, int aMin, int aMax);         ///< 値を指定の範囲 [min, max] に制限します。
-    static float Abs(float aValue);                                 ///< 値の絶対値を返します。
-    static int Abs(int aValue);                                     ///< 値の絶対値を返します。
-    static float LimitAbs(float aValue, float aLimitAbs);           ///< 値を指定の大きさに制限します。
-    static float Sqrt(float aValue);                                ///< 値の平方根を求めます。
-    static int Ceil(float aValue);                                  ///< 小数点の値を切り上げます。
-    static bool IsValid(float aValue);                              ///< 浮動小数点の値が有効値かどうかを判定します。
+    static constexpr bool IsEqualLoose(float aLhs, float aRhs);               ///< 二値が等しいかを誤差の範囲で判定します。
+    static constexpr float Max(float aLhs, float aRhs);                       ///< 二値のうち大きい方を返します。
+    static constexpr int Max(int aLhs, int aRhs);                             ///< 二値のうち大きい方を返します。
+    static constexpr float Min(float aLhs, float aRhs);                       ///< 二値のうち小さい方を返します。
+    static constexpr int Min(int aLhs, int aRhs);                             ///< 二値のうち小さい方を返します。
+    static constexpr float LimitMinMax(float aValue, float aMin, float aMax); ///< 値を指定の範囲 [min, max] に制限します。
+    static constexpr int LimitMinMax(int aValue, int aMin, int aMax);         ///< 値を指定の範囲 [min, max] に制限します。
+    static constexpr float Abs(float aValue);                                 ///< 値の絶対値を返します。
+    static constexpr int Abs(int aValue);                                     ///< 値の絶対値を返します。
+    static float LimitAbs(float aValue, float aLimitAbs);                     ///< 値を指定の大きさに制限します。
+    static float Sqrt(float aValue);                                          ///< 値の平方根を求めます。
+    static int Ceil(float aValue);                                            ///< 小数点の値を切り上げます。
+    static constexpr bool IsValid(float aValue);                              ///< 浮動小数点の値が有効値かどうかを判定します。
     //@}
 
     ///@name 三角関数
     //@{
-    static float Sin(float aRad);               ///< 正弦の値を求めます。
-    static float Cos(float aRad);               ///< 余弦の値を求めます。
-    static float Tan(float aRad);               ///< 正接の値を求めます。
-    static float ACos(float aCos);              ///< 余弦の値から角度を求めます。
-    static float ATan2(float aY, float aX);     ///< 対辺と隣辺の値から角度を求めます。
-    static float RadToDeg(float aRad);          ///< 弧度法で表された角度を度数法に変換します。
-    static float DegToRad(float aDeg);          ///< 度数法で表された角度を弧度法に変換します。
+    static float Sin(float aRad);                ///< 正弦の値を求めます。
+    static float Cos(float aRad);                ///< 余弦の値を求めます。
+    static float Tan(float aRad);                ///< 正接の値を求めます。
+    static float ACos(float aCos);               ///< 余弦の値から角度を求めます。
+    static float ATan2(float aY, float aX);      ///< 対辺と隣辺の値から角度を求めます。
+    static constexpr float RadToDeg(float aRad); ///< 弧度法で表された角度を度数法に変換します。
+    static constexpr float DegToRad(float aDeg); ///< 度数法で表された角度を弧度法に変換します。
     //@}
 
 private:
+    /// IsEqualLoose() の許容誤差。
+    static constexpr float LooseEps = 0.0001f;
+
     Math();
 };
 
+//------------------------------------------------------------------------------
+/// 二値が等しいかを誤差の範囲で判定します。
+///
+/// @param[in] aLhs 値の左辺。
+/// @param[in] aRhs 値の右辺。
+///
+/// @return aLhs と aRhs が誤差の範囲で等しければ @c true を返し
+///         そうでない場合は @c false を返します。
+constexpr bool Math::IsEqualLoose(float aLhs, float aRhs)
+{
+    return -LooseEps <= aLhs - aRhs && aLhs - aRhs <= LooseEps;
+}
+
+//------------------------------------------------------------------------------
+/// 二値のうち大きい方を返します。
+///
+/// @param[in] aLhs 値の左辺。
+/// @param[in] aRhs 値の右辺。
+///
+/// @return aLhs, aRhs のうち大きい方を返します。
+constexpr float Math::Max(float aLhs, float aRhs)
+{
+    return aLhs > aRhs ? aLhs : aRhs;
+}
+
+//------------------------------------------------------------------------------
+/// 二値のうち大きい方を返します。
+///
+/// @param[in] aLhs 値の左辺。
+/// @param[in] aRhs 値の右辺。
+///
+/// @return aLhs, aRhs のうち大きい方を返します。
+constexpr int Math::Max(int aLhs, int aRhs)
+{
+    return aLhs > aRhs ? aLhs : aRhs;
+}
+
+//------------------------------------------------------------------------------
+/// 二値のうち小さい方を返します。
+///
+/// @param[in] aLhs 値の左辺。
+/// @param[in] aRhs 値の右辺。
+///
+/// @return aLhs, aRhs のうち小さい方を返します。
+constexpr float Math::Min(float aLhs, float aRhs)
+{
+    return aLhs < aRhs ? aLhs : aRhs;
+}
+
+//------------------------------------------------------------------------------
+/// 二値のうち小さい方を返します。
+///
+/// @param[in] aLhs 値の左辺。
+/// @param[in] aRhs 値の右辺。
+///
+/// @return aLhs, aRhs のうち小さい方を返します。
+constexpr int Math::Min(int aLhs, int aRhs)
+{
+    return aLhs < aRhs ? aLhs : aRhs;
+}
+
+//------------------------------------------------------------------------------
+/// 値を指定の範囲 [min, max] に制限します。
+///
+/// @param[in] aValue 入力する値。
+/// @param[in] aMin   値の最小値。
+/// @param[in] aMax   値の最大値。
+///
+/// @return aValue を [aMin, aMax] の範囲に制限した値を返します。
+constexpr float Math::LimitMinMax(float aValue, float aMin, float aMax)
+{
+    return Max(Min(aValue, aMax), aMin);
+}
+
+//------------------------------------------------------------------------------
+/// 値を指定の範囲 [min, max] に制限します。
+///
+/// @param[in] aValue 入力する値。
+/// @param[in] aMin   値の最小値。
+/// @param[in] aMax   値の最大値。
+///
+/// @return aValue を [aMin, aMax] の範囲に制限した値を返します。
+constexpr int Math::LimitMinMax(int aValue, int aMin, int aMax)
+{
+    return Max(Min(aValue, aMax), aMin);
+}
+
+//------------------------------------------------------------------------------
+/// 値の絶対値を返します。
+///
+/// @return aValue の絶対値を返します。
+constexpr float Math::Abs(float aValue)
+{
+    return aValue >= 0.0f ? aValue : -aValue;
+}
+
+//------------------------------------------------------------------------------
+/// 値の絶対値を返します。
+///
+/// @return aValue の絶対値を返します。
+constexpr int Math::Abs(int aValue)
+{
+    return aValue >= 0 ? aValue : -aValue;
+}
+
+//------------------------------------------------------------------------------
+/// 値を指定の大きさに制限します。
+///
+/// @param[in] aValue    制限対象となる値。
+/// @param[in] aLimitAbs 制限する値。絶対値で与えます。
+///
+/// @return |aValue| が aLimitAbs を超えないように制限した値を返します。
+inline float Math::LimitAbs(float aValue, float aLimitAbs)
+{
+    HPC_LB_ASSERT_F(aLimitAbs, 0.0f);
+    return LimitMinMax(aValue, -aLimitAbs, aLimitAbs);
+}
+
+//------------------------------------------------------------------------------
+/// 値の平方根を求めます。
+///
+/// @return √aValue の値を返します。
+inline float Math::Sqrt(float aValue)
+{
+    HPC_MIN_ASSERT_F(aValue, 0.0f);
+    return std::sqrt(aValue);
+}
+
+//------------------------------------------------------------------------------
+/// 小数点の値を切り上げます。
+///
+/// @return aValue を切り上げて整数にした値を返します。
+inline int Math::Ceil(float aValue)
+{
+    return static_cast<int>(std::ceil(aValue));
+}
+
+//------------------------------------------------------------------------------
+/// 浮動小数点の値が有効値かどうかを判定します。
+///
+/// @param[in] aValue 判定する値。
+///
+/// @return aValue に与えられた浮動小数点の値が有効なら @c true を返し、
+///         無効な値 (inf, nan) の場合は @c false を返します。
+constexpr bool Math::IsValid(float aValue)
+{
+    return -std::numeric_limits<float>::max() <= aValue &&
+        aValue <= std::numeric_limits<float>::max();
+}
+
+//------------------------------------------------------------------------------
+/// 正弦の値を求めます。
+///
+/// @param[in] aRad 角度をラジアンで指定します。
+///
+/// @return sin(aRad) の値を返します。
+inline float Math::Sin(float aRad)
+{
+    return std::sin(aRad);
+}
+
+//------------------------------------------------------------------------------
+/// 余弦の値を求めます。
+///
+/// @param[in] aRad 角度をラジアンで指定します。
+///
+/// @return cos(aRad) の値を返します。
+inline float Math::Cos(float aRad)
+{
+    return std::cos(aRad);
+}
+
+//------------------------------------------------------------------------------
+/// 正接の値を求めます。
+///
+/// @param[in] aRad 角度をラジアンで指定します。
+///
+/// @return tan(aRad) の値を返します。
+inline float Math::Tan(float aRad)
+{
+    return std::tan(aRad);
+}
+
+//------------------------------------------------------------------------------
+/// 余弦の値から角度を求めます。
+///
+/// @param[in] aCos 余弦を表す値を指定します。
+///                 ただし、aCos の値は [-1.0f, 1.0f] にある必要があります。
+///
+/// @return cos^-1(aCos) の値を返します。
+inline float Math::ACos(float aCos)
+{
+    return std::acos(aCos);
+}
+
+//------------------------------------------------------------------------------
+/// 対辺と隣辺の値から角度を求めます。
+///
+/// @return tan^-1(aY / aX) の値を返します。
+inline float Math::ATan2(float aY, float aX)
+{
+    return std::atan2(aY, aX);
+}
+
+//------------------------------------------------------------------------------
+/// 弧度法で表された角度を度数法に変換します。
+///
+/// @param[in] aRad 角度をラジアンで指定します。
+///
+/// @return aRad を度数法(deg) で表した値を返します。
+constexpr float Math::RadToDeg(float aRad)
+{
+    return aRad * 180.0f / PI;
+}
+
+//------------------------------------------------------------------------------
+/// 度数法で表された角度を弧度法に変換します。
+///
+/// @param[in] aDeg 角度を度数で指定します。
+///
+/// @return aDeg を弧度法(rad) で表した値を返します。
+constexpr float Math::DegToRad(float aDeg)
+{
+    return aDeg * PI / 180.0f;
+}
+
 } // namespace
 // EOF
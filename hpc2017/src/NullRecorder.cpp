@@ -0,0 +1,74 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "NullRecorder.hpp"
+#include "Assert.hpp"
+#include "Print.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// NullRecorder クラスのインスタンスを生成します。
+NullRecorder::NullRecorder()
+: mStageTurns()
+, mTotalTurn(0)
+, mStage(nullptr)
+{
+}
+
+//------------------------------------------------------------------------------
+/// 結果を出力します。
+///
+/// Recorder::dumpResult() と同じ形式です。
+void NullRecorder::dumpResult(bool aIsSilent)const
+{
+    if (!aIsSilent) {
+        HPC_PRINTF("stage | turn\n");
+        for(int i = 0; i < stageCount(); ++i) {
+            HPC_PRINTF("% 5d | % 4d\n", i, stageTurn(i));
+        }
+    }
+    HPC_PRINTF("TotalTurn: %d\n", mTotalTurn);
+}
+
+//------------------------------------------------------------------------------
+/// ステージのターン数を記録します。
+void NullRecorder::addStageTurn(int aTurn)
+{
+    mStageTurns.push_back(aTurn);
+    mTotalTurn += aTurn;
+}
+
+//------------------------------------------------------------------------------
+/// 総ターン数を取得します。
+int NullRecorder::totalTurn()const
+{
+    return mTotalTurn;
+}
+
+//------------------------------------------------------------------------------
+/// 記録したステージ数を取得します。
+int NullRecorder::stageCount()const
+{
+    return int(mStageTurns.size());
+}
+
+//------------------------------------------------------------------------------
+/// ステージのターン数を取得します。
+///
+/// @param[in] aStageNumber ステージの番号。
+int NullRecorder::stageTurn(int aStageNumber)const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(aStageNumber, 0, stageCount());
+    return mStageTurns[aStageNumber];
+}
+
+} // namespace
+// EOF
@@ -0,0 +1,46 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include "Stage.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// ステージのターン数だけを記録するログ記録器。
+///
+/// Recorder と同じ関数を持ち、Game の記録器として使えます。
+/// ターンごとの関数は何もしないので、インライン展開されれば記録の費用はなくなります。
+/// Json は出力できません。
+class NullRecorder
+{
+public:
+    NullRecorder();
+    void dumpResult(bool aIsSilent)const;        ///< 結果を出力します。
+
+    void afterInitStage(const Stage& aStage) { mStage = &aStage; }  ///< ステージの初期化後に実行される関数。
+    void afterAdvanceTurn(const Stage&) {}                          ///< ターンを進めた後に実行される関数。
+    void afterFinishStage() { addStageTurn(mStage->turn()); }       ///< ステージが終了した後に実行される関数。
+    void afterFinishAllStages() {}                                  ///< 全ステージが終了した後に実行される関数。
+    void addStageTurn(int aTurn);                ///< ステージのターン数を記録します。
+
+    int totalTurn()const;                        ///< 総ターン数を取得します。
+    int stageCount()const;                       ///< 記録したステージ数を取得します。
+    int stageTurn(int aStageNumber)const;        ///< ステージのターン数を取得します。
+private:
+    std::vector<int> mStageTurns;   ///< ステージごとのターン数
+    int mTotalTurn;                 ///< 総ターン数
+    const Stage* mStage;            ///< 実行中のステージ (afterFinishStage() でターン数を読む)
+};
+
+} // namespace
+// EOF
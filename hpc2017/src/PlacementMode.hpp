@@ -0,0 +1,26 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// ステージ生成時の家の配置方法。
+enum PlacementMode
+{
+    PlacementMode_Legacy,   ///< 空いているマスに当たるまで乱数を引き直します。既存のシード値と同じ配置になります。
+    PlacementMode_FreeCell, ///< 空きマスの集合から直接選びます。配置の分布は Legacy と同じですが、配置自体は異なります。
+
+    PlacementMode_TERM,
+};
+
+} // namespace
+// EOF
@@ -0,0 +1,365 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "PlanFile.hpp"
+
+#include <cstring>
+#include "Assert.hpp"
+
+namespace hpc {
+
+static_assert(sizeof(PlanFormat::Header) == 16, "invalid header size");
+static_assert(sizeof(float) == sizeof(uint32_t), "invalid float size");
+
+//------------------------------------------------------------------------------
+/// PlanStage クラスのインスタンスを生成します。
+PlanStage::PlanStage()
+: seed(RandomSeed::DefaultSeed())
+, placementMode(PlacementMode_Legacy)
+, turns()
+{
+}
+
+//------------------------------------------------------------------------------
+/// プランどおりに進まなかったかを取得します。
+///
+/// 何も起こらなかった行動がある、プランが終わる前に配達が終わった、
+/// プランが終わっても配達が終わらなかった、のいずれかに当たれば true です。
+bool PlanVerification::StageResult::diverged()const
+{
+    return invalid
+        || rejectedActionCount != 0
+        || !finished
+        || turn != planTurnCount;
+}
+
+//------------------------------------------------------------------------------
+/// PlanVerification クラスのインスタンスを生成します。
+PlanVerification::PlanVerification()
+: stages()
+, broken(false)
+{
+}
+
+//------------------------------------------------------------------------------
+/// プランどおりに進まなかったステージ数を取得します。
+int PlanVerification::divergedStageCount()const
+{
+    int count = 0;
+    for (const auto& stage : stages) {
+        if (stage.diverged()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------
+/// PlanWriter クラスのインスタンスを生成します。
+PlanWriter::PlanWriter()
+: mFile(nullptr)
+, mStageCount(0)
+, mTurnCount(0)
+, mHasError(false)
+, mBuffer()
+{
+}
+
+//------------------------------------------------------------------------------
+/// PlanWriter クラスのインスタンスを破棄します。
+PlanWriter::~PlanWriter()
+{
+    close();
+}
+
+//------------------------------------------------------------------------------
+/// プランファイルを作成します。
+///
+/// @param[in] aPath プランファイルのパス。既にあれば上書きします。
+bool PlanWriter::open(const char* aPath)
+{
+    close();
+
+    mFile = std::fopen(aPath, "wb");
+    if (mFile == nullptr) {
+        return false;
+    }
+    mStageCount = 0;
+    mHasError = false;
+
+    // ステージ数は close() で確定する
+    PlanFormat::Header header = {};
+    return std::fwrite(&header, sizeof(header), 1, mFile) == 1;
+}
+
+//------------------------------------------------------------------------------
+/// ステージの記録を始めます。
+///
+/// @param[in] aSeed ステージのシード値。
+/// @param[in] aMode 家の配置方法。
+void PlanWriter::beginStage(RandomSeed aSeed, PlacementMode aMode)
+{
+    HPC_ASSERT(mFile != nullptr);
+
+    mBuffer.clear();
+    mTurnCount = 0;
+    put(aSeed.x);
+    put(aSeed.y);
+    put(aSeed.z);
+    put(aSeed.w);
+    put(uint32_t(aMode));
+    put(uint32_t(0)); // ターン数は endStage() で確定する
+}
+
+//------------------------------------------------------------------------------
+/// ターンを記録します。
+void PlanWriter::addTurn(const Actions& aActions, const TargetPositions& aTargetPositions)
+{
+    HPC_ASSERT(aTargetPositions.count() == Parameter::UFOCount);
+
+    put(uint32_t(aActions.count()));
+    for (const auto& action : aActions) {
+        uint32_t arg1 = 0;
+        uint32_t arg2 = 0;
+        switch (action.type()) {
+            case ActionType_PickUp:
+                arg1 = uint32_t(action.ufoIndex());
+                break;
+            case ActionType_Pass:
+                arg1 = uint32_t(action.srcUFOIndex());
+                arg2 = uint32_t(action.dstUFOIndex());
+                break;
+            case ActionType_Deliver:
+                arg1 = uint32_t(action.ufoIndex());
+                arg2 = uint32_t(action.houseIndex());
+                break;
+            default:
+                HPC_SHOULD_NOT_REACH_HERE();
+        }
+        put(uint32_t(action.type()) | (arg1 << 8) | (arg2 << 16));
+    }
+    for (const auto& pos : aTargetPositions) {
+        put(pos.x);
+        put(pos.y);
+    }
+    ++mTurnCount;
+}
+
+//------------------------------------------------------------------------------
+/// ステージのレコードを書き出します。
+bool PlanWriter::endStage()
+{
+    HPC_ASSERT(mFile != nullptr);
+
+    const int TurnCountIndex = 5;
+    mBuffer[TurnCountIndex] = uint32_t(mTurnCount);
+    if (std::fwrite(mBuffer.data(), sizeof(uint32_t), mBuffer.size(), mFile) != mBuffer.size()) {
+        mHasError = true;
+        return false;
+    }
+    ++mStageCount;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// 1ステージ分のプランをまとめて書き出します。
+///
+/// beginStage(), addTurn(), endStage() を順に呼び出すのと同じです。
+bool PlanWriter::addStage(const PlanStage& aStage)
+{
+    beginStage(aStage.seed, aStage.placementMode);
+    for (const auto& turn : aStage.turns) {
+        addTurn(turn.actions, turn.targetPositions);
+    }
+    return endStage();
+}
+
+//------------------------------------------------------------------------------
+/// ヘッダを確定してファイルを閉じます。
+///
+/// @return 途中の書き出しも含めてすべて成功していれば true を返します。
+bool PlanWriter::close()
+{
+    if (mFile == nullptr) {
+        return true;
+    }
+
+    PlanFormat::Header header = {};
+    header.magic = PlanFormat::Magic;
+    header.version = PlanFormat::Version;
+    header.stageCount = uint32_t(mStageCount);
+
+    bool ok = !mHasError
+        && std::fseek(mFile, 0, SEEK_SET) == 0
+        && std::fwrite(&header, sizeof(header), 1, mFile) == 1;
+    ok = std::fclose(mFile) == 0 && ok;
+    mFile = nullptr;
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+/// プランファイルを開いているかを取得します。
+bool PlanWriter::isOpen()const
+{
+    return mFile != nullptr;
+}
+
+//------------------------------------------------------------------------------
+void PlanWriter::put(uint32_t aValue)
+{
+    mBuffer.push_back(aValue);
+}
+
+//------------------------------------------------------------------------------
+void PlanWriter::put(float aValue)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &aValue, sizeof(bits));
+    mBuffer.push_back(bits);
+}
+
+//------------------------------------------------------------------------------
+/// PlanReader クラスのインスタンスを生成します。
+PlanReader::PlanReader()
+: mFile(nullptr)
+, mStageCount(0)
+{
+}
+
+//------------------------------------------------------------------------------
+/// PlanReader クラスのインスタンスを破棄します。
+PlanReader::~PlanReader()
+{
+    close();
+}
+
+//------------------------------------------------------------------------------
+/// プランファイルを開きます。
+///
+/// @return 開くことができ、ヘッダが正しければ true を返します。
+bool PlanReader::open(const char* aPath)
+{
+    close();
+
+    mFile = std::fopen(aPath, "rb");
+    if (mFile == nullptr) {
+        return false;
+    }
+
+    PlanFormat::Header header;
+    if (std::fread(&header, sizeof(header), 1, mFile) != 1
+        || header.magic != PlanFormat::Magic
+        || header.version != PlanFormat::Version
+        ) {
+        close();
+        return false;
+    }
+    mStageCount = int(header.stageCount);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// プランファイルを閉じます。
+void PlanReader::close()
+{
+    if (mFile != nullptr) {
+        std::fclose(mFile);
+    }
+    mFile = nullptr;
+    mStageCount = 0;
+}
+
+//------------------------------------------------------------------------------
+/// ステージ数を取得します。
+int PlanReader::stageCount()const
+{
+    return mStageCount;
+}
+
+//------------------------------------------------------------------------------
+/// 次のステージのプランを読み込みます。
+///
+/// @param[out] aStage 読み込んだプラン。
+/// @return ファイルが壊れていなければ true を返します。
+bool PlanReader::readStage(PlanStage& aStage)
+{
+    HPC_ASSERT(mFile != nullptr);
+
+    uint32_t x, y, z, w, mode, turnCount;
+    if (!get(x) || !get(y) || !get(z) || !get(w) || !get(mode) || !get(turnCount)) {
+        return false;
+    }
+    if (mode >= uint32_t(PlacementMode_TERM) || turnCount > uint32_t(Parameter::GameTurnLimit)) {
+        return false;
+    }
+    aStage.seed = RandomSeed(x, y, z, w);
+    aStage.placementMode = PlacementMode(mode);
+    aStage.turns.resize(turnCount);
+
+    for (auto& turn : aStage.turns) {
+        uint32_t actionCount;
+        if (!get(actionCount) || actionCount > uint32_t(Parameter::MaxActionPerTurn)) {
+            return false;
+        }
+        turn.actions.clear();
+        for (uint32_t i = 0; i < actionCount; ++i) {
+            uint32_t packed;
+            if (!get(packed)) {
+                return false;
+            }
+            const int arg1 = int((packed >> 8) & 0xFF);
+            const int arg2 = int((packed >> 16) & 0xFF);
+            // 家の番号はステージの家の数が分かってから確かめる
+            if (arg1 >= Parameter::UFOCount
+                || ((packed & 0xFF) == ActionType_Pass && arg2 >= Parameter::UFOCount)
+                || arg2 >= Parameter::MaxHouseCount
+                ) {
+                return false;
+            }
+            switch (packed & 0xFF) {
+                case ActionType_PickUp:
+                    turn.actions.add(Action::PickUp(arg1));
+                    break;
+                case ActionType_Pass:
+                    turn.actions.add(Action::Pass(arg1, arg2));
+                    break;
+                case ActionType_Deliver:
+                    turn.actions.add(Action::Deliver(arg1, arg2));
+                    break;
+                default:
+                    return false;
+            }
+        }
+        turn.targetPositions.clear();
+        for (int i = 0; i < Parameter::UFOCount; ++i) {
+            float posX, posY;
+            if (!get(posX) || !get(posY)) {
+                return false;
+            }
+            turn.targetPositions.add(Vector2(posX, posY));
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool PlanReader::get(uint32_t& aValue)
+{
+    return std::fread(&aValue, sizeof(aValue), 1, mFile) == 1;
+}
+
+//------------------------------------------------------------------------------
+bool PlanReader::get(float& aValue)
+{
+    return std::fread(&aValue, sizeof(aValue), 1, mFile) == 1;
+}
+
+} // namespace
+// EOF
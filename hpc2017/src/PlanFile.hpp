@@ -0,0 +1,141 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "PlacementMode.hpp"
+#include "RandomSeed.hpp"
+#include "Stage.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// 解答の記録 (プラン) のファイル形式。
+///
+/// ファイルはヘッダと、ステージごとの可変長レコードの並びです。値はすべてリトルエンディアンです。
+///
+/// ステージのレコード:
+/// - シード値 x, y, z, w (uint32 x 4), 家の配置方法 (uint32), ターン数 (uint32)
+/// - ターンごとに、行動の数 (uint32), 行動 (4 バイト x 行動の数), UFO の目標座標 (float x 2 x Parameter::UFOCount)
+///
+/// 行動は 種類, 引数1, 引数2, 予約 (uint8 x 4) です。
+/// 引数は PickUp なら (UFO, 0)、Pass なら (渡す UFO, 受け取る UFO)、Deliver なら (UFO, 家) です。
+struct PlanFormat
+{
+    static const uint32_t Magic = 0x50435048;   ///< "HPCP"
+    static const uint32_t Version = 1;          ///< 形式のバージョン
+
+    /// ファイルの先頭。
+    struct Header
+    {
+        uint32_t magic;         ///< Magic
+        uint32_t version;       ///< Version
+        uint32_t stageCount;    ///< ステージ数
+        uint32_t reserved;      ///< 予約領域 (0)
+    };
+};
+
+//------------------------------------------------------------------------------
+/// 1ターン分のプラン。
+struct PlanTurn
+{
+    Actions actions;                ///< 箱の受け渡しフェーズの行動
+    TargetPositions targetPositions;///< UFOの移動フェーズの目標座標
+};
+
+//------------------------------------------------------------------------------
+/// 1ステージ分のプラン。
+struct PlanStage
+{
+    PlanStage();
+
+    RandomSeed seed;                ///< ステージのシード値
+    PlacementMode placementMode;    ///< 家の配置方法
+    std::vector<PlanTurn> turns;    ///< ターンごとのプラン
+};
+
+//------------------------------------------------------------------------------
+/// プランを再生した結果。
+struct PlanVerification
+{
+    /// 1ステージ分の結果。
+    struct StageResult
+    {
+        int turn;                   ///< 再生したターン数
+        int planTurnCount;          ///< プランのターン数
+        int rejectedActionCount;    ///< 事前条件を満たさず、何も起こらなかった行動の数
+        bool finished;              ///< すべての家に配達できたか
+        bool invalid;               ///< 範囲外の家の番号や不正な座標があったか
+
+        bool diverged()const;       ///< プランどおりに進まなかったかを取得します。
+    };
+
+    PlanVerification();
+    int divergedStageCount()const;  ///< プランどおりに進まなかったステージ数を取得します。
+
+    std::vector<StageResult> stages;///< ステージごとの結果
+    bool broken;                    ///< プランファイルが壊れていたか
+};
+
+//------------------------------------------------------------------------------
+/// プランの書き出し。
+///
+/// ステージのレコードはステージが終わるまでメモリに溜め、endStage() で書き出します。
+class PlanWriter
+{
+public:
+    PlanWriter();
+    ~PlanWriter();
+    bool open(const char* aPath);                               ///< プランファイルを作成します。
+    void beginStage(RandomSeed aSeed, PlacementMode aMode);     ///< ステージの記録を始めます。
+    void addTurn(const Actions& aActions, const TargetPositions& aTargetPositions); ///< ターンを記録します。
+    bool endStage();                                            ///< ステージのレコードを書き出します。
+    bool addStage(const PlanStage& aStage);                     ///< 1ステージ分のプランをまとめて書き出します。
+    bool close();                                               ///< ヘッダを確定してファイルを閉じます。
+    bool isOpen()const;                                         ///< プランファイルを開いているかを取得します。
+private:
+    PlanWriter(const PlanWriter&);
+    PlanWriter& operator=(const PlanWriter&);
+    void put(uint32_t aValue);
+    void put(float aValue);
+
+    std::FILE* mFile;                                           ///< 書き出し先
+    int mStageCount;                                            ///< 書き出したステージ数
+    int mTurnCount;                                             ///< 記録中のステージのターン数
+    bool mHasError;                                             ///< 書き出しに失敗したことがあるか
+    std::vector<uint32_t> mBuffer;                              ///< 記録中のステージのレコード
+};
+
+//------------------------------------------------------------------------------
+/// プランの読み込み。
+class PlanReader
+{
+public:
+    PlanReader();
+    ~PlanReader();
+    bool open(const char* aPath);                   ///< プランファイルを開きます。
+    void close();                                   ///< プランファイルを閉じます。
+    int stageCount()const;                          ///< ステージ数を取得します。
+    bool readStage(PlanStage& aStage);              ///< 次のステージのプランを読み込みます。
+private:
+    PlanReader(const PlanReader&);
+    PlanReader& operator=(const PlanReader&);
+    bool get(uint32_t& aValue);
+    bool get(float& aValue);
+
+    std::FILE* mFile;                               ///< 読み込み元
+    int mStageCount;                                ///< ステージ数
+};
+
+} // namespace
+// EOF
@@ -12,6 +12,97 @@
 
 namespace hpc {
 
+namespace {
+
+//------------------------------------------------------------------------------
+/// xorshift128 の状態を1つ進めます。
+void Advance(RandomSeed& aSeed)
+{
+    const uint t = (aSeed.x ^ (aSeed.x << 11));
+    aSeed.x = aSeed.y;
+    aSeed.y = aSeed.z;
+    aSeed.z = aSeed.w;
+    aSeed.w = (aSeed.w ^ (aSeed.w >> 19)) ^ (t ^ (t >> 8));
+}
+
+//------------------------------------------------------------------------------
+/// xorshift128 の状態遷移を表す GF(2) 上の 128x128 行列。
+///
+/// 状態 (x, y, z, w) を 128 ビットのベクトルとみなすと、1回の遷移は線形写像になります。
+/// 列 i は、i ビット目だけが立った状態を遷移させた結果です。
+struct TransitionMatrix
+{
+    static const int Size = 128;
+
+    /// 状態に行列を掛けます。
+    RandomSeed apply(const RandomSeed& aSeed)const
+    {
+        const uint words[4] = { aSeed.x, aSeed.y, aSeed.z, aSeed.w };
+        uint result[4] = {};
+        for (int i = 0; i < Size; ++i) {
+            // 分岐させずに、ビットが立っている列だけを足し込む
+            const uint mask = 0u - ((words[i / 32] >> (i % 32)) & 1u);
+            for (int j = 0; j < 4; ++j) {
+                result[j] ^= columns[i][j] & mask;
+            }
+        }
+        return RandomSeed(result[0], result[1], result[2], result[3]);
+    }
+
+    /// 列を設定します。
+    void setColumn(int aIndex, const RandomSeed& aSeed)
+    {
+        columns[aIndex][0] = aSeed.x;
+        columns[aIndex][1] = aSeed.y;
+        columns[aIndex][2] = aSeed.z;
+        columns[aIndex][3] = aSeed.w;
+    }
+
+    /// 列を取得します。
+    RandomSeed column(int aIndex)const
+    {
+        return RandomSeed(columns[aIndex][0], columns[aIndex][1], columns[aIndex][2], columns[aIndex][3]);
+    }
+
+    uint columns[Size][4];
+};
+
+//------------------------------------------------------------------------------
+/// 遷移行列の 2^k 乗 (k = 0, 1, ..., 64) の表。
+///
+/// 最初に使うときに一度だけ作ります。(およそ 130KB)
+struct JumpTable
+{
+    static const int Count = 65;
+
+    JumpTable()
+    {
+        for (int i = 0; i < TransitionMatrix::Size; ++i) {
+            uint words[4] = {};
+            words[i / 32] = 1u << (i % 32);
+            RandomSeed unit(words[0], words[1], words[2], words[3]);
+            Advance(unit);
+            powers[0].setColumn(i, unit);
+        }
+        for (int k = 1; k < Count; ++k) {
+            // T^(2^k) = T^(2^(k-1)) * T^(2^(k-1))
+            for (int i = 0; i < TransitionMatrix::Size; ++i) {
+                powers[k].setColumn(i, powers[k - 1].apply(powers[k - 1].column(i)));
+            }
+        }
+    }
+
+    static const JumpTable& Get()
+    {
+        static const JumpTable table;
+        return table;
+    }
+
+    TransitionMatrix powers[Count];
+};
+
+} // namespace
+
 //------------------------------------------------------------------------------
 Random::Random(const RandomSeed& aRandomSeed)
 : mRandomSeed(aRandomSeed)
@@ -65,5 +156,40 @@ float Random::randFloat()
     return float(randU32() % 0x10000) / float(0x10000);
 }
 
+//------------------------------------------------------------------------------
+/// 乱数を aStepCount 回取得した後の状態に進めます。
+///
+/// 遷移行列の 2^k 乗を掛け合わせるので、aStepCount のビット数に比例する時間で済みます。
+///
+/// @param[in] aStepCount 進める回数。randU32() の呼び出し回数に相当します。
+void Random::jump(uint64_t aStepCount)
+{
+    const JumpTable& table = JumpTable::Get();
+    for (int k = 0; aStepCount != 0; ++k, aStepCount >>= 1) {
+        if (aStepCount & 1) {
+            mRandomSeed = table.powers[k].apply(mRandomSeed);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/// 独立した乱数列を切り出します。
+///
+/// 現在の状態から始まる乱数生成器を返し、自身は 2^64 回分進めます。
+/// 切り出した乱数列は 2^64 回取得するまで、自身や他の切り出した乱数列と重なりません。
+Random Random::split()
+{
+    Random child(*this);
+    mRandomSeed = JumpTable::Get().powers[64].apply(mRandomSeed);
+    return child;
+}
+
+//------------------------------------------------------------------------------
+/// 現在の状態を取得します。
+const RandomSeed& Random::seed()const
+{
+    return mRandomSeed;
+}
+
 } // namespace
 // EOF
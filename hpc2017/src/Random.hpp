@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include "RandomSeed.hpp"
 
 namespace hpc {
@@ -25,6 +26,9 @@ public:
     uint randU32();                         ///< uint の範囲で整数の乱数を取得します。
     float randFloatTerm(float aTerm);       ///< [0, aTerm) の範囲で実数の乱数を取得します。
     float randFloat();                      ///< [0, 1.0f) の範囲で実数の乱数を取得します。
+    void jump(uint64_t aStepCount);         ///< 乱数を aStepCount 回取得した後の状態に進めます。
+    Random split();                         ///< 独立した乱数列を切り出します。
+    const RandomSeed& seed()const;          ///< 現在の状態を取得します。
 private:
     RandomSeed mRandomSeed;                 ///< 乱数のシード
 };
@@ -0,0 +1,27 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// Simulator::run() のログの記録方法。
+enum RecordMode
+{
+    RecordMode_TurnCount,   ///< ステージのターン数だけを記録します。(NullRecorder)
+    RecordMode_Full,        ///< 全ターンを記録し、実行後に Json を出力できます。(Recorder)
+    RecordMode_Stream,      ///< ステージが終わるたびにログを JSON Lines で書き出します。(StreamingRecorder)
+
+    RecordMode_TERM,
+};
+
+} // namespace
+// EOF
@@ -9,6 +9,7 @@
 
 #include "Recorder.hpp"
 #include "ArrayNum.hpp"
+#include "Assert.hpp"
 #include "Print.hpp"
 
 namespace hpc {
@@ -25,6 +26,7 @@ Recorder::Recorder()
 //------------------------------------------------------------------------------
 /// 結果をJson形式で出力します。
 ///
+/// @note ターンごとの記録がある先頭の Parameter::GameStageCount ステージまでを出力します。
 /// @pre すべてのステージの記録が完了している必要があります。
 void Recorder::dumpJson()const
 {
@@ -33,33 +35,15 @@ void Recorder::dumpJson()const
         /// 合計ターン数
         HPC_PRINTF("%d,", mGameRecord.totalTurn);
         // 定数情報
-        HPC_PRINTF("["); {
-            HPC_PRINTF("%d,", Parameter::GameTurnLimit);
-            HPC_PRINTF("%d,", Parameter::StageWidth);
-            HPC_PRINTF("%d,", Parameter::StageHeight);
-            HPC_PRINTF("%d,", Parameter::OfficeRadius);
-            HPC_PRINTF("%d,", Parameter::HouseRadius);
-
-            HPC_PRINTF("["); {
-                HPC_PRINTF("["); {
-                    HPC_PRINTF("%d,", Parameter::LargeUFORadius);
-                    HPC_PRINTF("%d,", Parameter::LargeUFOCapacity);
-                    HPC_PRINTF("%d", Parameter::LargeUFOMaxSpeed);
-                } HPC_PRINTF("],");
-                HPC_PRINTF("["); {
-                    HPC_PRINTF("%d,", Parameter::SmallUFORadius);
-                    HPC_PRINTF("%d,", Parameter::SmallUFOCapacity);
-                    HPC_PRINTF("%d", Parameter::SmallUFOMaxSpeed);
-                } HPC_PRINTF("]");
-            } HPC_PRINTF("]");
-        } HPC_PRINTF("],");
+        DumpJsonParameters();
+        HPC_PRINTF(",");
         // ステージのログ
         HPC_PRINTF("["); {
-            for(int i = 0; i < Parameter::GameStageCount; ++i) {
+            for(int i = 0; i < stageCount() && hasStageRecord(i); ++i) {
                 if(i != 0) {
                     HPC_PRINTF(",");
                 }
-                dumpJsonStage(mGameRecord.stageRecords[i]);
+                DumpJsonStage(mGameRecord.stageRecords[i]);
             }
         } HPC_PRINTF("]");
     } HPC_PRINTF("]");
@@ -75,8 +59,8 @@ void Recorder::dumpResult(bool aIsSilent)const
 {
     if (!aIsSilent) {
         HPC_PRINTF("stage | turn\n");
-        for(int i = 0; i < Parameter::GameStageCount; ++i) {
-            HPC_PRINTF("% 5d | % 4d\n", i, mGameRecord.stageRecords[i].turn);
+        for(int i = 0; i < stageCount(); ++i) {
+            HPC_PRINTF("% 5d | % 4d\n", i, stageTurn(i));
         }
     }
     HPC_PRINTF("TotalTurn: %d\n", mGameRecord.totalTurn);
@@ -88,17 +72,13 @@ void Recorder::dumpResult(bool aIsSilent)const
 /// @note StageRecord 等に値を設定します。
 void Recorder::afterInitStage(const Stage& aStage)
 {
-    StageRecord& stageRecord = mGameRecord.stageRecords[mCurrentStageNumber];
-
     mCurrentTurn = 0;
 
-    stageRecord.officePos = aStage.office().pos();
-    for (int i = 0; i < aStage.houses().count(); ++i) {
-        stageRecord.housePos[i] = aStage.houses()[i].pos();
+    if (!hasStageRecord(mCurrentStageNumber)) {
+        return;
     }
-    stageRecord.houseCount = aStage.houses().count();
 
-    writeTurnRecord(mCurrentStageNumber, 0, aStage);
+    WriteStageRecord(mGameRecord.stageRecords[mCurrentStageNumber], aStage);
 }
 
 //------------------------------------------------------------------------------
@@ -109,7 +89,9 @@ void Recorder::afterAdvanceTurn(const Stage& aStage)
 {
     ++mCurrentTurn;
 
-    writeTurnRecord(mCurrentStageNumber, mCurrentTurn, aStage);
+    if (hasStageRecord(mCurrentStageNumber)) {
+        WriteTurnRecord(mGameRecord.stageRecords[mCurrentStageNumber].turnRecords[mCurrentTurn], aStage);
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -118,9 +100,11 @@ void Recorder::afterAdvanceTurn(const Stage& aStage)
 /// @note turn 等に値を設定します。
 void Recorder::afterFinishStage()
 {
-    StageRecord& stageRecord = mGameRecord.stageRecords[mCurrentStageNumber];
+    if (hasStageRecord(mCurrentStageNumber)) {
+        mGameRecord.stageRecords[mCurrentStageNumber].turn = mCurrentTurn;
+    }
 
-    stageRecord.turn = mCurrentTurn;
+    mGameRecord.stageTurns.push_back(mCurrentTurn);
 
     mGameRecord.totalTurn += mCurrentTurn;
 
@@ -133,9 +117,47 @@ void Recorder::afterFinishAllStages()
 {
 }
 
+//------------------------------------------------------------------------------
+/// ターンごとの記録をせずに、ステージのターン数だけを記録します。
+///
+/// ステージを並列に実行したときに、書き出しスレッドが番号順に呼び出します。
+/// StageRecord は記録しないので、dumpJson() とは併用できません。
+void Recorder::addStageTurn(int aTurn)
+{
+    mGameRecord.stageTurns.push_back(aTurn);
+    mGameRecord.totalTurn += aTurn;
+    ++mCurrentStageNumber;
+}
+
+//------------------------------------------------------------------------------
+/// 定数情報をJson形式で出力します。
+void Recorder::DumpJsonParameters()
+{
+    HPC_PRINTF("["); {
+        HPC_PRINTF("%d,", Parameter::GameTurnLimit);
+        HPC_PRINTF("%d,", Parameter::StageWidth);
+        HPC_PRINTF("%d,", Parameter::StageHeight);
+        HPC_PRINTF("%d,", Parameter::OfficeRadius);
+        HPC_PRINTF("%d,", Parameter::HouseRadius);
+
+        HPC_PRINTF("["); {
+            HPC_PRINTF("["); {
+                HPC_PRINTF("%d,", Parameter::LargeUFORadius);
+                HPC_PRINTF("%d,", Parameter::LargeUFOCapacity);
+                HPC_PRINTF("%d", Parameter::LargeUFOMaxSpeed);
+            } HPC_PRINTF("],");
+            HPC_PRINTF("["); {
+                HPC_PRINTF("%d,", Parameter::SmallUFORadius);
+                HPC_PRINTF("%d,", Parameter::SmallUFOCapacity);
+                HPC_PRINTF("%d", Parameter::SmallUFOMaxSpeed);
+            } HPC_PRINTF("]");
+        } HPC_PRINTF("]");
+    } HPC_PRINTF("]");
+}
+
 //------------------------------------------------------------------------------
 /// ステージのログをJson形式で出力します。
-void Recorder::dumpJsonStage(const StageRecord& aRecord)const
+void Recorder::DumpJsonStage(const StageRecord& aRecord)
 {
     HPC_PRINTF("["); {
         // ターン数
@@ -166,7 +188,7 @@ void Recorder::dumpJsonStage(const StageRecord& aRecord)const
                 if(i != 0) {
                     HPC_PRINTF(",");
                 }
-                dumpJsonTurn(aRecord.turnRecords[i]);
+                DumpJsonTurn(aRecord.turnRecords[i]);
             }
         } HPC_PRINTF("]");
     } HPC_PRINTF("]");
@@ -174,7 +196,7 @@ void Recorder::dumpJsonStage(const StageRecord& aRecord)const
 
 //------------------------------------------------------------------------------
 /// ターンのログをJson形式で出力します。
-void Recorder::dumpJsonTurn(const TurnRecord& aRecord)const
+void Recorder::DumpJsonTurn(const TurnRecord& aRecord)
 {
     HPC_PRINTF("["); {
         // UFO情報
@@ -197,12 +219,10 @@ void Recorder::dumpJsonTurn(const TurnRecord& aRecord)const
         // 配達情報
         HPC_PRINTF("["); {
             const int Unit = sizeof(uint) * 8;
-            auto delivered = aRecord.delivered; // コピー
             for (int i = 0; i < (Parameter::MaxHouseCount + (Unit - 1)) / Unit; ++i) {
                 uint elem = 0;
                 for (int j = 0; j < Unit; ++j) {
-                    elem |= delivered.test(0) << j;
-                    delivered >>= 1;
+                    elem |= uint(aRecord.delivered.contains(i * Unit + j)) << j;
                 }
 
                 if (i != 0) {
@@ -215,22 +235,32 @@ void Recorder::dumpJsonTurn(const TurnRecord& aRecord)const
 }
 
 //------------------------------------------------------------------------------
-/// TurnRecord に値を設定します。
-void Recorder::writeTurnRecord(int aStageNumber, int aTurn, const Stage& aStage)
+/// StageRecord にマップ情報と 0 ターン目を設定します。
+void Recorder::WriteStageRecord(StageRecord& aRecord, const Stage& aStage)
 {
-    TurnRecord& turnRecord = mGameRecord.stageRecords[aStageNumber].turnRecords[aTurn];
+    aRecord.officePos = aStage.office().pos();
+    for (int i = 0; i < aStage.houses().count(); ++i) {
+        aRecord.housePos[i] = aStage.houses()[i].pos();
+    }
+    aRecord.houseCount = aStage.houses().count();
 
+    WriteTurnRecord(aRecord.turnRecords[0], aStage);
+}
+
+//------------------------------------------------------------------------------
+/// TurnRecord に値を設定します。
+void Recorder::WriteTurnRecord(TurnRecord& aRecord, const Stage& aStage)
+{
     for (int i = 0; i < aStage.ufos().count(); ++i) {
         const UFO& ufo = aStage.ufos()[i];
-        UFORecord& ufoRecord = turnRecord.ufos[i];
+        UFORecord& ufoRecord = aRecord.ufos[i];
         ufoRecord.type = ufo.type();
         ufoRecord.pos = ufo.pos();
         ufoRecord.itemCount = ufo.itemCount();
     }
 
-    for (int i = 0; i < aStage.houses().count(); ++i) {
-        turnRecord.delivered.set(i, aStage.houses()[i].delivered());
-    }
+    // StreamingRecorder は記録を使い回すので、前のステージの家の分も上書きする
+    aRecord.delivered = aStage.deliveredHouses();
 }
 
 //------------------------------------------------------------------------------
@@ -242,5 +272,29 @@ int Recorder::totalTurn()const
     return mGameRecord.totalTurn;
 }
 
+//------------------------------------------------------------------------------
+/// 記録したステージ数を取得します。
+int Recorder::stageCount()const
+{
+    return int(mGameRecord.stageTurns.size());
+}
+
+//------------------------------------------------------------------------------
+/// ステージのターン数を取得します。
+///
+/// @param[in] aStageNumber ステージの番号。
+int Recorder::stageTurn(int aStageNumber)const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(aStageNumber, 0, stageCount());
+    return mGameRecord.stageTurns[aStageNumber];
+}
+
+//------------------------------------------------------------------------------
+/// StageRecord を記録するステージかを取得します。
+bool Recorder::hasStageRecord(int aStageNumber)const
+{
+    return aStageNumber < Parameter::GameStageCount;
+}
+
 } // namespace
 // EOF
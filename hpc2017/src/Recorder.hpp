@@ -9,7 +9,7 @@
 
 #pragma once
 
-#include <bitset>
+#include <vector>
 #include "Stage.hpp"
 
 namespace hpc {
@@ -27,9 +27,15 @@ public:
     void afterAdvanceTurn(const Stage& aStage);  ///< ターンを進めた後に実行される関数。
     void afterFinishStage();                     ///< ステージが終了した後に実行される関数。
     void afterFinishAllStages();                 ///< 全ステージが終了した後に実行される関数。
+    void addStageTurn(int aTurn);                ///< ターンごとの記録をせずに、ステージのターン数だけを記録します。
 
     int totalTurn()const;                        ///< 総ターン数を取得します。
-private:
+    int stageCount()const;                       ///< 記録したステージ数を取得します。
+    int stageTurn(int aStageNumber)const;        ///< ステージのターン数を取得します。
+
+    /// @name 記録の形式
+    /// StreamingRecorder と共有します。
+    //@{
     struct UFORecord
     {
         Vector2 pos;
@@ -39,7 +45,7 @@ private:
     struct TurnRecord
     {
         UFORecord ufos[Parameter::UFOCount];
-        std::bitset<Parameter::MaxHouseCount> delivered;
+        HouseSet delivered;
     };
     struct StageRecord
     {
@@ -49,15 +55,25 @@ private:
         int houseCount;
         TurnRecord turnRecords[Parameter::GameTurnLimit + 1];
     };
+
+    static void DumpJsonParameters();                                       ///< 定数情報をJson形式で出力します。
+    static void DumpJsonStage(const StageRecord& aRecord);                  ///< ステージのログをJson形式で出力します。
+    static void WriteStageRecord(StageRecord& aRecord, const Stage& aStage); ///< StageRecord にマップ情報と 0 ターン目を設定します。
+    static void WriteTurnRecord(TurnRecord& aRecord, const Stage& aStage);   ///< TurnRecord に値を設定します。
+    //@}
+
+private:
+    /// @note ターンごとの記録を残すのは先頭の Parameter::GameStageCount ステージだけです。
+    ///       それ以降のステージはターン数だけを stageTurns に記録します。
     struct GameRecord
     {
         int totalTurn;
+        std::vector<int> stageTurns;
         StageRecord stageRecords[Parameter::GameStageCount];
     };
 
-    void dumpJsonStage(const StageRecord& aRecord)const;                    ///< ステージのログをJson形式で出力します。
-    void dumpJsonTurn(const TurnRecord& aRecord)const;                      ///< ターンのログをJson形式で出力します。
-    void writeTurnRecord(int aStageNumber, int aTurn, const Stage& aStage); ///< TurnRecord に値を設定します。
+    static void DumpJsonTurn(const TurnRecord& aRecord);                    ///< ターンのログをJson形式で出力します。
+    bool hasStageRecord(int aStageNumber)const;                             ///< StageRecord を記録するステージかを取得します。
 
     GameRecord mGameRecord;   ///< 記録用の構造体
 
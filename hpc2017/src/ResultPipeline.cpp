@@ -0,0 +1,169 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "ResultPipeline.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include "Assert.hpp"
+#include "Print.hpp"
+
+namespace hpc {
+
+namespace {
+
+/// キューが空のときや、書き出し待ちがいっぱいのときに待つ時間。
+/// 1ステージの実行には数十ミリ秒かかるので、この程度の遅れは問題になりません。
+const std::chrono::microseconds IdleWait(100);
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/// StageOutput のインスタンスを生成します。
+StageOutput::StageOutput()
+: stageIndex(0)
+, turn(0)
+, plan()
+{
+}
+
+//------------------------------------------------------------------------------
+/// ResultPipeline のインスタンスを生成します。
+///
+/// @param[in] aPlanWriter プランの書き出し先。記録しなければ nullptr。
+/// @param[in] aIsSilent   概要の行を出力しないか。
+ResultPipeline::ResultPipeline(PlanWriter* aPlanWriter, bool aIsSilent)
+: mQueue()
+, mPending()
+, mWrittenCount(0)
+, mStageCount(-1)
+, mThread()
+, mStageTurns()
+, mPlanWriter(aPlanWriter)
+, mIsSilent(aIsSilent)
+{
+}
+
+//------------------------------------------------------------------------------
+/// ResultPipeline のインスタンスを破棄します。
+///
+/// @pre start() した場合は finish() を呼び出している必要があります。
+ResultPipeline::~ResultPipeline()
+{
+    HPC_ASSERT(!mThread.joinable());
+}
+
+//------------------------------------------------------------------------------
+/// 書き出しスレッドを開始します。
+void ResultPipeline::start()
+{
+    if (!mIsSilent) {
+        HPC_PRINTF("stage | turn\n");
+    }
+    mThread = std::thread(&ResultPipeline::writeLoop, this);
+}
+
+//------------------------------------------------------------------------------
+/// aStageIndex の結果を入れられるようになるまで待ちます。
+///
+/// ステージの実行を始める前に呼び出してください。
+/// 書き出し待ちの結果が Depth を超えないので、キューが満杯になることもありません。
+void ResultPipeline::waitForSlot(int aStageIndex)const
+{
+    while (aStageIndex >= mWrittenCount.load(std::memory_order_acquire) + Depth) {
+        std::this_thread::sleep_for(IdleWait);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// 結果を渡します。どのワーカーからも呼び出せます。
+///
+/// @param[in] aOutput new で確保した結果。書き出しスレッドが delete します。
+void ResultPipeline::push(StageOutput* aOutput)
+{
+    HPC_ASSERT(aOutput != nullptr);
+    while (!mQueue.tryPush(aOutput)) {
+        std::this_thread::yield();
+    }
+}
+
+//------------------------------------------------------------------------------
+/// aStageCount 個の結果を書き出し終えるまで待ち、書き出しスレッドを終了します。
+void ResultPipeline::finish(int aStageCount)
+{
+    mStageCount.store(aStageCount, std::memory_order_release);
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+}
+
+//------------------------------------------------------------------------------
+/// 書き出したステージのターン数を番号順に取得します。
+///
+/// @pre finish() を呼び出している必要があります。
+const std::vector<int>& ResultPipeline::stageTurns()const
+{
+    HPC_ASSERT(!mThread.joinable());
+    return mStageTurns;
+}
+
+//------------------------------------------------------------------------------
+/// 書き出しスレッドの本体。
+///
+/// 届いた結果を番号の位置に置き、次に書き出す番号の結果がそろっている限り書き出します。
+void ResultPipeline::writeLoop()
+{
+    int next = 0;
+    for (;;) {
+        const int stageCount = mStageCount.load(std::memory_order_acquire);
+        if (stageCount >= 0 && next >= stageCount) {
+            break;
+        }
+
+        StageOutput* output = nullptr;
+        if (!mQueue.tryPop(output)) {
+            std::this_thread::sleep_for(IdleWait);
+            continue;
+        }
+
+        HPC_RANGE_ASSERT_MIN_UB_I(output->stageIndex, next, next + Depth);
+        StageOutput*& slot = mPending[output->stageIndex % Depth];
+        HPC_ASSERT(slot == nullptr);
+        slot = output;
+
+        while (mPending[next % Depth] != nullptr) {
+            StageOutput* ready = mPending[next % Depth];
+            mPending[next % Depth] = nullptr;
+            write(*ready);
+            delete ready;
+            ++next;
+            mWrittenCount.store(next, std::memory_order_release);
+        }
+        if (!mIsSilent) {
+            std::fflush(stdout);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/// 結果を1つ書き出します。
+void ResultPipeline::write(const StageOutput& aOutput)
+{
+    if (!mIsSilent) {
+        HPC_PRINTF("% 5d | % 4d\n", aOutput.stageIndex, aOutput.turn);
+    }
+    mStageTurns.push_back(aOutput.turn);
+    if (mPlanWriter != nullptr) {
+        mPlanWriter->addStage(aOutput.plan);
+    }
+}
+
+} // namespace
+// EOF
@@ -0,0 +1,69 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "MPSCQueue.hpp"
+#include "PlanFile.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// ワーカーが実行を終えた1ステージの結果。
+struct StageOutput
+{
+    StageOutput();
+
+    int stageIndex;         ///< ステージの番号
+    int turn;               ///< かかったターン数
+    PlanStage plan;         ///< 解答のプラン (記録しなければ空)
+};
+
+//------------------------------------------------------------------------------
+/// ステージを並列に実行するワーカーから、結果を書き出し専用のスレッドへ渡す経路。
+///
+/// - ワーカーは push() で結果をロックのないキューに入れ、書き出しを待たずに次のステージへ進みます。
+/// - 書き出しスレッドはステージの番号順に並べ直し、次の番号がそろい次第、
+///   概要の行・プランへ書き出し、ターン数を番号順に集めます。
+/// - ワーカーは waitForSlot() で、書き出し待ちの結果が Depth を超えないように待ちます。
+///   メモリはステージ数ではなく Depth に比例します。
+class ResultPipeline
+{
+public:
+    static const int Depth = 64;    ///< 書き出し待ちにできる結果の数
+
+    ResultPipeline(PlanWriter* aPlanWriter, bool aIsSilent);
+    ~ResultPipeline();
+    void start();                           ///< 書き出しスレッドを開始します。
+    void waitForSlot(int aStageIndex)const; ///< aStageIndex の結果を入れられるようになるまで待ちます。
+    void push(StageOutput* aOutput);        ///< 結果を渡します。所有権は書き出し側へ移ります。
+    void finish(int aStageCount);           ///< aStageCount 個の結果を書き出し終えるまで待ちます。
+    const std::vector<int>& stageTurns()const; ///< 書き出したステージのターン数を番号順に取得します。
+private:
+    ResultPipeline(const ResultPipeline&);
+    ResultPipeline& operator=(const ResultPipeline&);
+    void writeLoop();                       ///< 書き出しスレッドの本体。
+    void write(const StageOutput& aOutput); ///< 結果を1つ書き出します。
+
+    MPSCQueue<StageOutput*, Depth> mQueue;  ///< ワーカーから書き出しスレッドへのキュー
+    StageOutput* mPending[Depth];           ///< 順番待ちの結果 (ステージの番号 % Depth)
+    std::atomic<int> mWrittenCount;         ///< 書き出し終えた結果の数
+    std::atomic<int> mStageCount;           ///< 全ステージ数 (確定するまでは -1)
+    std::thread mThread;                    ///< 書き出しスレッド
+    std::vector<int> mStageTurns;           ///< 書き出したステージのターン数 (書き出しスレッドだけが触る)
+    PlanWriter* mPlanWriter;                ///< プランの書き出し先 (記録しなければ nullptr)
+    bool mIsSilent;                         ///< 概要の行を出力しないか
+};
+
+} // namespace
+// EOF
@@ -9,15 +9,51 @@
 
 #include "Answer.hpp"
 #include "Simulator.hpp"
+#include "Assert.hpp"
 #include "Parameter.hpp"
 #include "Print.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
 namespace hpc {
 
+namespace {
+
+//------------------------------------------------------------------------------
+/// 開いているコーパスがあればそのステージで、なければ生成したステージでゲームを実行します。
+template <class TGame>
+void RunGame(TGame& aGame, Answer& aAnswer, const StageCorpus& aCorpus)
+{
+    if (aCorpus.isOpen()) {
+        aGame.run(aAnswer, aCorpus);
+    } else {
+        aGame.run(aAnswer);
+    }
+}
+
+} // namespace
+
 //------------------------------------------------------------------------------
 /// Simulator クラスのインスタンスを生成します。
 Simulator::Simulator()
 : mGame(RandomSeed::DefaultSeed())
+, mTurnCountGame(RandomSeed::DefaultSeed())
+, mStreamingGame(RandomSeed::DefaultSeed())
+, mRecordMode(RecordMode_TurnCount)
+, mCorpus()
+, mPlanWriter()
+, mVerification()
+, mIsVerified(false)
+, mIsParallel(false)
+, mTournament()
+, mIsTournament(false)
+, mTuner()
+, mIsTuning(false)
+, mWallSec(0.0)
+, mBounds()
 {
 }
 
@@ -28,6 +64,93 @@ Simulator::Simulator()
 void Simulator::changeSeed(RandomSeed aSeed)
 {
     mGame.changeSeed(aSeed);
+    mTurnCountGame.changeSeed(aSeed);
+    mStreamingGame.changeSeed(aSeed);
+}
+
+//------------------------------------------------------------------------------
+/// ステージを読み飛ばします。
+///
+/// @pre changeSeed() の後、run() を実行する前に設定する必要があります。
+void Simulator::skipStages(int aStageCount)
+{
+    mGame.skipStages(aStageCount);
+    mTurnCountGame.skipStages(aStageCount);
+    mStreamingGame.skipStages(aStageCount);
+}
+
+//------------------------------------------------------------------------------
+/// 家の配置方法を変更します。
+///
+/// @pre run() を実行する前に設定する必要があります。
+void Simulator::changePlacementMode(PlacementMode aMode)
+{
+    mGame.changePlacementMode(aMode);
+    mTurnCountGame.changePlacementMode(aMode);
+    mStreamingGame.changePlacementMode(aMode);
+}
+
+//------------------------------------------------------------------------------
+/// run() のログの記録方法を変更します。
+///
+/// 既定の RecordMode_TurnCount はターンごとの記録をしないので、最も速く実行できます。
+/// Json を出力するときは RecordMode_Full にしてください。
+/// run() 以外の実行は、記録方法にかかわらずターン数だけを記録します。
+///
+/// @pre run() を実行する前に設定する必要があります。
+void Simulator::changeRecordMode(RecordMode aMode)
+{
+    HPC_ENUM_ASSERT(RecordMode, aMode);
+    mRecordMode = aMode;
+}
+
+//------------------------------------------------------------------------------
+/// ステージコーパスを開きます。
+///
+/// 開いたコーパスがあれば、run() はステージを生成せずにコーパスのステージを使います。
+///
+/// @pre run() を実行する前に設定する必要があります。
+bool Simulator::openCorpus(const char* aPath)
+{
+    return mCorpus.open(aPath);
+}
+
+//------------------------------------------------------------------------------
+/// ステージを生成してコーパスに書き出します。
+///
+/// @param[in] aPath コーパスファイルのパス。
+/// @param[in] aStageCount 生成するステージ数。
+bool Simulator::writeCorpus(const char* aPath, int aStageCount)
+{
+    return mTurnCountGame.writeCorpus(aPath, aStageCount);
+}
+
+//------------------------------------------------------------------------------
+/// run() の解答をプランに記録します。
+///
+/// @pre run() を実行する前に設定する必要があります。
+/// @pre ステージコーパスとは併用できません。
+bool Simulator::recordPlan(const char* aPath)
+{
+    if (!mPlanWriter.open(aPath)) {
+        return false;
+    }
+    mGame.changePlanWriter(&mPlanWriter);
+    mTurnCountGame.changePlanWriter(&mPlanWriter);
+    mStreamingGame.changePlanWriter(&mPlanWriter);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// 記録したプランを閉じます。
+///
+/// @return プランをすべて書き出せたら true を返します。
+bool Simulator::closePlan()
+{
+    mGame.changePlanWriter(nullptr);
+    mTurnCountGame.changePlanWriter(nullptr);
+    mStreamingGame.changePlanWriter(nullptr);
+    return mPlanWriter.close();
 }
 
 //------------------------------------------------------------------------------
@@ -35,7 +158,127 @@ void Simulator::changeSeed(RandomSeed aSeed)
 void Simulator::run()
 {
     Answer answer;
-    mGame.run(answer);
+    switch (mRecordMode) {
+    case RecordMode_Full:
+        RunGame(mGame, answer, mCorpus);
+        break;
+    case RecordMode_Stream:
+        RunGame(mStreamingGame, answer, mCorpus);
+        break;
+    default:
+        RunGame(mTurnCountGame, answer, mCorpus);
+        break;
+    }
+}
+
+//------------------------------------------------------------------------------
+/// ステージを並列に実行します。
+///
+/// ステージごとの行は、実行中にステージの番号順に出力します。
+/// Time は全スレッドの CPU 時間の合計なので、経過時間は WallTime として別に出力します。
+///
+/// @param[in] aThreadCount ワーカースレッドの数。
+/// @param[in] aIsSilent ステージごとの行を出力しないか。
+void Simulator::runParallel(int aThreadCount, bool aIsSilent)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    if (mCorpus.isOpen()) {
+        mTurnCountGame.runParallel(aThreadCount, aIsSilent, mCorpus);
+    } else {
+        mTurnCountGame.runParallel(aThreadCount, aIsSilent);
+    }
+    mWallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    mIsParallel = true;
+    mRecordMode = RecordMode_TurnCount;
+}
+
+//------------------------------------------------------------------------------
+/// 登録された複数の解答を同じステージで実行します。
+///
+/// 解答は AnswerRegistry の登録名を ',' で区切って指定します。先頭の解答が基準になります。
+/// 結果は printResult() で出力します。
+///
+/// @param[in] aNames 解答の登録名の並び。例: "answer,no-anneal"
+/// @param[in] aThreadCount ワーカースレッドの数。
+/// @return 登録されていない名前があれば、何も実行せずに false を返します。
+bool Simulator::runTournament(const char* aNames, int aThreadCount)
+{
+    std::vector<const AnswerEntry*> entries;
+    const char* name = aNames;
+    for (;;) {
+        const char* comma = std::strchr(name, ',');
+        const std::string token = comma != nullptr ? std::string(name, comma) : std::string(name);
+        const AnswerEntry* entry = AnswerRegistry::Instance().find(token.c_str());
+        if (entry == nullptr) {
+            return false;
+        }
+        entries.push_back(entry);
+        if (comma == nullptr) {
+            break;
+        }
+        name = comma + 1;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    if (mCorpus.isOpen()) {
+        mTurnCountGame.runTournament(entries, aThreadCount, mTournament, mCorpus);
+    } else {
+        mTurnCountGame.runTournament(entries, aThreadCount, mTournament);
+    }
+    mWallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    mIsTournament = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// 解答の定数の設定を比べます。
+///
+/// 既定値と、範囲から選んだ設定と、aSweeps で1つの定数だけを変えた設定を、提出する解答で比べます。
+/// 範囲から選ぶ値は、ステージのシード値によらず毎回同じです。
+/// 結果は printResult() で出力します。
+///
+/// @param[in] aRandomCount 範囲から選ぶ設定の数。
+/// @param[in] aSweeps "名前=値1,値2,..." の形の文字列の配列。
+/// @param[in] aThreadCount ワーカーの数。
+/// @return aSweeps に読めないものがあれば false を返します。
+bool Simulator::runTuning(int aRandomCount, const std::vector<const char*>& aSweeps, int aThreadCount)
+{
+    Random random(RandomSeed::DefaultSeed());
+    mTuner.addDefault();
+    mTuner.addRandom(aRandomCount, random);
+    for (const char* sweep : aSweeps) {
+        if (!mTuner.addSweep(sweep)) {
+            return false;
+        }
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    if (mCorpus.isOpen()) {
+        mTurnCountGame.runTuning(mTuner, aThreadCount, mCorpus);
+    } else {
+        mTurnCountGame.runTuning(mTuner, aThreadCount);
+    }
+    mWallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    mIsTuning = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// 解答を使わずにプランを再生します。
+///
+/// 結果は printResult() で出力します。
+///
+/// @return プランファイルを開けなければ false を返します。
+bool Simulator::verifyPlan(const char* aPath)
+{
+    PlanReader reader;
+    if (!reader.open(aPath)) {
+        return false;
+    }
+    mTurnCountGame.replay(reader, mVerification);
+    mIsVerified = true;
+    mRecordMode = RecordMode_TurnCount;
+    return true;
 }
 
 //------------------------------------------------------------------------------
@@ -44,26 +287,132 @@ void Simulator::run()
 /// @pre 事前に run() を実行している必要があります。
 void Simulator::printResult(bool aIsSilent)const
 {
-    mGame.recorder().dumpResult(aIsSilent);
-    HPC_PRINTF("Time: %.3f sec\n", mGame.timer().elapsedSec());
+    if (mIsVerified) {
+        printVerification(aIsSilent);
+        HPC_PRINTF("Time: %.3f sec\n", elapsedSec());
+        return;
+    }
+    if (mIsTournament) {
+        // Time は解答ごとに出力する
+        mTournament.print(aIsSilent);
+        HPC_PRINTF("WallTime: %.3f sec\n", mWallSec);
+        return;
+    }
+    if (mIsTuning) {
+        // 時間は設定ごとに出力する
+        mTuner.print(aIsSilent);
+        HPC_PRINTF("WallTime: %.3f sec\n", mWallSec);
+        return;
+    }
+
+    // 並列に実行したときは、ステージごとの行を実行中に出力済み
+    switch (mRecordMode) {
+    case RecordMode_Full:
+        mGame.recorder().dumpResult(aIsSilent || mIsParallel);
+        break;
+    case RecordMode_Stream:
+        mStreamingGame.recorder().dumpResult(aIsSilent || mIsParallel);
+        break;
+    default:
+        mTurnCountGame.recorder().dumpResult(aIsSilent || mIsParallel);
+        break;
+    }
+    if (mCorpus.isOpen() && mCorpus.hasReferenceTurns()) {
+        int referenceTotalTurn = 0;
+        for (int i = 0; i < mCorpus.stageCount(); ++i) {
+            referenceTotalTurn += mCorpus.referenceTurn(i);
+        }
+        HPC_PRINTF("ReferenceTotalTurn: %d (%+d)\n", referenceTotalTurn, totalTurn() - referenceTotalTurn);
+    }
+    HPC_PRINTF("Time: %.3f sec\n", elapsedSec());
+    if (mIsParallel) {
+        HPC_PRINTF("WallTime: %.3f sec\n", mWallSec);
+    }
 }
 
 //------------------------------------------------------------------------------
 /// Jsonを出力します。
 ///
-/// @pre 事前に run() を実行している必要があります。
+/// @pre 事前に RecordMode_Full で run() を実行している必要があります。
 void Simulator::printJson()const
 {
+    HPC_ASSERT(mRecordMode == RecordMode_Full);
     mGame.recorder().dumpJson();
 }
 
+//------------------------------------------------------------------------------
+/// 実行するステージの下界を求めます。
+///
+/// ステージを読み飛ばす設定とコーパスを開いた後、run() か runParallel() の前に呼び出してください。
+void Simulator::computeBounds()
+{
+    mTurnCountGame.computeBounds(mBounds, mCorpus.isOpen() ? &mCorpus : nullptr);
+}
+
+//------------------------------------------------------------------------------
+/// 結果と下界との差を出力します。
+///
+/// ステージごとの行に続けて、差の大きい順にステージを並べます。
+/// 差の大きいステージほど改善の余地があり、差が 0 のステージはこれ以上速くなりません。
+///
+/// @param[in] aIsSilent ステージごとの行を省き、差の大きい順も上位だけにするか。
+/// @pre computeBounds() を呼んだ後に、RecordMode_TurnCount で run() か runParallel() を実行している必要があります。
+void Simulator::printGap(bool aIsSilent)const
+{
+    const NullRecorder& recorder = mTurnCountGame.recorder();
+    HPC_ASSERT(mRecordMode == RecordMode_TurnCount);
+    HPC_ASSERT(recorder.stageCount() == int(mBounds.size()));
+
+    const int stageCount = recorder.stageCount();
+    std::vector<int> gaps(stageCount);
+    int totalBound = 0;
+    for (int i = 0; i < stageCount; ++i) {
+        gaps[i] = recorder.stageTurn(i) - mBounds[i].best();
+        totalBound += mBounds[i].best();
+    }
+
+    HPC_PRINTF("[gap]\n");
+    if (!aIsSilent) {
+        HPC_PRINTF("stage | turn | bound | farthest | trips | tree |  gap\n");
+        for (int i = 0; i < stageCount; ++i) {
+            const StageBound& bound = mBounds[i];
+            HPC_PRINTF("% 5d | % 4d | % 5d | % 8d | % 5d | % 4d | % 4d\n",
+                i, recorder.stageTurn(i), bound.best(), bound.farthest, bound.trips, bound.tree, gaps[i]);
+        }
+    }
+
+    // 差の大きい順。同じ差ならステージの番号順
+    std::vector<int> order(stageCount);
+    for (int i = 0; i < stageCount; ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&gaps](int aLhs, int aRhs) { return gaps[aLhs] > gaps[aRhs]; });
+    const int shownCount = aIsSilent ? std::min(stageCount, 10) : stageCount;
+    HPC_PRINTF("rank | stage | turn | bound |  gap\n");
+    for (int n = 0; n < shownCount; ++n) {
+        const int i = order[n];
+        HPC_PRINTF("% 4d | % 5d | % 4d | % 5d | % 4d\n", n + 1, i, recorder.stageTurn(i), mBounds[i].best(), gaps[i]);
+    }
+
+    const int totalGap = recorder.totalTurn() - totalBound;
+    HPC_PRINTF("TotalBound: %d\n", totalBound);
+    HPC_PRINTF("TotalGap: %d (%.1f%%)\n", totalGap, recorder.totalTurn() > 0 ? 100.0 * totalGap / recorder.totalTurn() : 0.0);
+}
+
 //------------------------------------------------------------------------------
 /// 総ターン数を取得します。
 ///
 /// @pre 事前に run() を実行している必要があります。
 int Simulator::totalTurn()const
 {
-    return mGame.recorder().totalTurn();
+    switch (mRecordMode) {
+    case RecordMode_Full:
+        return mGame.recorder().totalTurn();
+    case RecordMode_Stream:
+        return mStreamingGame.recorder().totalTurn();
+    default:
+        return mTurnCountGame.recorder().totalTurn();
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -72,7 +421,46 @@ int Simulator::totalTurn()const
 /// @pre 事前に run() を実行している必要があります。
 double Simulator::elapsedSec()const
 {
-    return mGame.timer().elapsedSec();
+    switch (mRecordMode) {
+    case RecordMode_Full:
+        return mGame.timer().elapsedSec();
+    case RecordMode_Stream:
+        return mStreamingGame.timer().elapsedSec();
+    default:
+        return mTurnCountGame.timer().elapsedSec();
+    }
+}
+
+//------------------------------------------------------------------------------
+/// プランを再生した結果を出力します。
+///
+/// サイレントモードでは、プランどおりに進まなかったステージだけを出力します。
+void Simulator::printVerification(bool aIsSilent)const
+{
+    HPC_PRINTF("stage | turn | plan | rejected | status\n");
+    for (int i = 0; i < int(mVerification.stages.size()); ++i) {
+        const PlanVerification::StageResult& result = mVerification.stages[i];
+        if (aIsSilent && !result.diverged()) {
+            continue;
+        }
+        const char* status = "ok";
+        if (result.invalid) {
+            status = "invalid";
+        } else if (result.finished && result.turn < result.planTurnCount) {
+            status = "early-finish";
+        } else if (!result.finished) {
+            status = "unfinished";
+        } else if (result.rejectedActionCount != 0) {
+            status = "rejected";
+        }
+        HPC_PRINTF("% 5d | % 4d | % 4d | % 8d | %s\n",
+            i, result.turn, result.planTurnCount, result.rejectedActionCount, status);
+    }
+    if (mVerification.broken) {
+        HPC_PRINTF("Broken plan file after stage %d.\n", int(mVerification.stages.size()));
+    }
+    HPC_PRINTF("TotalTurn: %d\n", totalTurn());
+    HPC_PRINTF("DivergedStages: %d\n", mVerification.divergedStageCount());
 }
 
 } // namespace
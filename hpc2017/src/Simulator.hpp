@@ -10,6 +10,7 @@
 #pragma once
 
 #include "Game.hpp"
+#include "RecordMode.hpp"
 
 namespace hpc {
 
@@ -20,13 +21,42 @@ class Simulator
 public:
     Simulator();
     void changeSeed(RandomSeed aSeed);     ///< シード値を変更します。
+    void skipStages(int aStageCount);      ///< ステージを読み飛ばします。
+    void changePlacementMode(PlacementMode aMode); ///< 家の配置方法を変更します。
+    void changeRecordMode(RecordMode aMode); ///< run() のログの記録方法を変更します。
+    bool openCorpus(const char* aPath);    ///< ステージコーパスを開きます。
+    bool writeCorpus(const char* aPath, int aStageCount); ///< ステージを生成してコーパスに書き出します。
+    bool recordPlan(const char* aPath);    ///< run() の解答をプランに記録します。
+    bool closePlan();                      ///< 記録したプランを閉じます。
     void run();                            ///< ゲームを実行します。
+    void runParallel(int aThreadCount, bool aIsSilent); ///< ステージを並列に実行します。
+    bool runTournament(const char* aNames, int aThreadCount); ///< 登録された複数の解答を同じステージで実行します。
+    bool runTuning(int aRandomCount, const std::vector<const char*>& aSweeps, int aThreadCount); ///< 解答の定数の設定を比べます。
+    bool verifyPlan(const char* aPath);    ///< 解答を使わずにプランを再生します。
     void printResult(bool aIsSilent)const; ///< 結果を出力します。
     void printJson()const;                 ///< Jsonを出力します。
+    void computeBounds();                  ///< 実行するステージの下界を求めます。
+    void printGap(bool aIsSilent)const;    ///< 結果と下界との差を出力します。
     int totalTurn()const;                  ///< 総ターン数を取得します。
     double elapsedSec()const;              ///< 実行時間を秒に変換したものを取得します。
 private:
-    Game mGame;                            ///< ゲーム全体
+    void printVerification(bool aIsSilent)const; ///< プランを再生した結果を出力します。
+
+    Game mGame;                            ///< 全ターンを記録するゲーム (RecordMode_Full)
+    TurnCountGame mTurnCountGame;          ///< ターン数だけを記録するゲーム (RecordMode_TurnCount と、run() 以外の実行)
+    StreamingGame mStreamingGame;          ///< ログを書き出しながら実行するゲーム (RecordMode_Stream)
+    RecordMode mRecordMode;                ///< run() のログの記録方法
+    StageCorpus mCorpus;                   ///< ステージコーパス (開いていなければ生成したステージを使う)
+    PlanWriter mPlanWriter;                ///< プランの書き出し先
+    PlanVerification mVerification;        ///< プランを再生した結果
+    bool mIsVerified;                      ///< run() ではなく verifyPlan() を実行したか
+    bool mIsParallel;                      ///< run() ではなく runParallel() を実行したか
+    Tournament mTournament;                ///< 複数の解答を実行した結果
+    bool mIsTournament;                    ///< run() ではなく runTournament() を実行したか
+    Tuner mTuner;                          ///< 定数の設定を比べた結果
+    bool mIsTuning;                        ///< run() ではなく runTuning() を実行したか
+    double mWallSec;                       ///< runParallel(), runTournament(), runTuning() の経過時間 (秒)
+    std::vector<StageBound> mBounds;       ///< ステージごとの下界 (computeBounds() で求める)
 };
 
 } // namespace
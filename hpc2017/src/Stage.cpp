@@ -11,17 +11,209 @@
 #include "ArrayNum.hpp"
 #include "Assert.hpp"
 #include "Math.hpp"
+#include "Stats.hpp"
 #include "Util.hpp"
 
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
 namespace hpc {
 
+namespace {
+
+//------------------------------------------------------------------------------
+/// 空きマスの集合。
+///
+/// 添字で要素を取り出せ、削除は末尾の要素と入れ替えることで O(1) で行います。
+class FreeCellList
+{
+public:
+    explicit FreeCellList(int aCellCount)
+    : mCells()
+    , mSlots(aCellCount, -1)
+    {
+    }
+
+    void add(int aCell)
+    {
+        HPC_ASSERT(mSlots[aCell] < 0);
+        mSlots[aCell] = int(mCells.size());
+        mCells.push_back(aCell);
+    }
+
+    void remove(int aCell)
+    {
+        const int slot = mSlots[aCell];
+        if (slot < 0) {
+            return;
+        }
+        const int last = mCells.back();
+        mCells[slot] = last;
+        mSlots[last] = slot;
+        mCells.pop_back();
+        mSlots[aCell] = -1;
+    }
+
+    int count()const { return int(mCells.size()); }
+    int operator[](int aIndex)const { return mCells[aIndex]; }
+
+private:
+    std::vector<int> mCells;  ///< 空きマスの番号
+    std::vector<int> mSlots;  ///< マスごとの mCells 内の位置 (なければ -1)
+};
+
+//------------------------------------------------------------------------------
+/// 重み付きのマスの集合。
+///
+/// Fenwick 木で重みの累積和を管理し、重みに比例した選択と削除を O(log n) で行います。
+class WeightedCellTree
+{
+public:
+    explicit WeightedCellTree(int aCellCount)
+    : mTree(aCellCount + 1, 0)
+    , mWeights(aCellCount, 0)
+    , mTotal(0)
+    {
+    }
+
+    void setWeight(int aCell, int64_t aWeight)
+    {
+        const int64_t diff = aWeight - mWeights[aCell];
+        mWeights[aCell] = aWeight;
+        mTotal += diff;
+        for (int i = aCell + 1; i < int(mTree.size()); i += i & -i) {
+            mTree[i] += diff;
+        }
+    }
+
+    /// 累積和が aValue を超える最初のマスを返します。
+    int find(int64_t aValue)const
+    {
+        HPC_ASSERT(0 <= aValue && aValue < mTotal);
+        int pos = 0;
+        int step = 1;
+        while (step * 2 < int(mTree.size())) {
+            step *= 2;
+        }
+        for (; step > 0; step /= 2) {
+            if (pos + step < int(mTree.size()) && mTree[pos + step] <= aValue) {
+                pos += step;
+                aValue -= mTree[pos];
+            }
+        }
+        return pos;
+    }
+
+    int64_t weight(int aCell)const { return mWeights[aCell]; }
+    int64_t total()const { return mTotal; }
+
+private:
+    std::vector<int64_t> mTree;     ///< Fenwick 木
+    std::vector<int64_t> mWeights;  ///< マスごとの重み
+    int64_t mTotal;                 ///< 重みの合計
+};
+
+//------------------------------------------------------------------------------
+/// 1/r を原点を角とする長方形 [0, aX] x [0, aY] で積分した値を求めます。
+///
+/// 符号付きの座標を受け付けます。
+double RectMassFromOrigin(double aX, double aY)
+{
+    if (aX == 0.0 || aY == 0.0) {
+        return 0.0;
+    }
+    const double x = std::fabs(aX);
+    const double y = std::fabs(aY);
+    const double mass = x * std::asinh(y / x) + y * std::asinh(x / y);
+    return (aX < 0) != (aY < 0) ? -mass : mass;
+}
+
+//------------------------------------------------------------------------------
+/// 街の各マスの重みを求めます。
+///
+/// 距離と角度を一様乱数で決めた位置がマスに入る確率に比例する値で、
+/// 密度 1/r をマスの範囲のうち半径 aRadius の円の内側で積分したものです。
+/// 円に完全に含まれるマスは角の値から厳密に、円の境界にかかるマスは分割した中点で求めます。
+///
+/// @param[in] aOriginX 左下のマスの左下の角の、街の中心から見た x 座標。
+/// @param[in] aOriginY 左下のマスの左下の角の、街の中心から見た y 座標。
+/// @param[in] aCellSize マスの一辺の長さ。
+/// @param[in] aBoxSize 縦横のマスの数。
+/// @param[in] aRadius 円の半径。
+/// @param[out] aMasses マスの重み。aBoxSize * aBoxSize 個の要素を設定します。
+void TownCellMasses(double aOriginX, double aOriginY, double aCellSize, int aBoxSize, double aRadius, std::vector<double>& aMasses)
+{
+    const int Split = 8;
+    const int cornerCount = aBoxSize + 1;
+    const double radiusSq = aRadius * aRadius;
+
+    std::vector<double> cornerMasses(cornerCount * cornerCount);
+    for (int y = 0; y < cornerCount; ++y) {
+        for (int x = 0; x < cornerCount; ++x) {
+            cornerMasses[y * cornerCount + x] =
+                RectMassFromOrigin(aOriginX + x * aCellSize, aOriginY + y * aCellSize);
+        }
+    }
+
+    aMasses.assign(aBoxSize * aBoxSize, 0.0);
+    for (int y = 0; y < aBoxSize; ++y) {
+        for (int x = 0; x < aBoxSize; ++x) {
+            const double x0 = aOriginX + x * aCellSize;
+            const double y0 = aOriginY + y * aCellSize;
+            const double x1 = x0 + aCellSize;
+            const double y1 = y0 + aCellSize;
+
+            // マスの中で原点に最も近い点と最も遠い点
+            const double nearX = x0 > 0 ? x0 : (x1 < 0 ? x1 : 0.0);
+            const double nearY = y0 > 0 ? y0 : (y1 < 0 ? y1 : 0.0);
+            const double farX = std::fmax(std::fabs(x0), std::fabs(x1));
+            const double farY = std::fmax(std::fabs(y0), std::fabs(y1));
+            double& mass = aMasses[y * aBoxSize + x];
+            if (nearX * nearX + nearY * nearY >= radiusSq) {
+                mass = 0.0;
+            } else if (farX * farX + farY * farY <= radiusSq) {
+                mass = cornerMasses[(y + 1) * cornerCount + (x + 1)] - cornerMasses[(y + 1) * cornerCount + x]
+                    - cornerMasses[y * cornerCount + (x + 1)] + cornerMasses[y * cornerCount + x];
+            } else {
+                // 境界のマスは中心から離れていて密度の変化が小さいので、中点で近似する
+                const double step = aCellSize / Split;
+                for (int sy = 0; sy < Split; ++sy) {
+                    for (int sx = 0; sx < Split; ++sx) {
+                        const double px = x0 + (sx + 0.5) * step;
+                        const double py = y0 + (sy + 0.5) * step;
+                        const double distSq = px * px + py * py;
+                        if (distSq < radiusSq) {
+                            mass += step * step / std::sqrt(distSq);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// TownCellMasses() の重みを整数に変換する倍率
+const double TownMassScale = double(1 << 20);
+
+//------------------------------------------------------------------------------
+/// [0, aTerm) の範囲で 64 ビット整数の乱数を取得します。
+int64_t RandTerm64(Random& aRandom, int64_t aTerm)
+{
+    const uint64_t hi = aRandom.randU32();
+    const uint64_t lo = aRandom.randU32();
+    return int64_t(((hi << 32) | lo) % uint64_t(aTerm));
+}
+
+} // namespace
+
 //------------------------------------------------------------------------------
 /// Stage クラスのインスタンスを生成します。
 ///
 /// @note 引数が同じならば、ステージも同じものが生成されます。
 Stage::Stage(RandomSeed aSeed)
 : mTurn(0)
-, mRestItemCount(0)
+, mUndeliveredHouses()
 , mOffice()
 , mUFOs()
 , mHouses()
@@ -31,43 +223,14 @@ Stage::Stage(RandomSeed aSeed)
 
 //------------------------------------------------------------------------------
 /// ステージを初期化します。
-void Stage::init()
+///
+/// @param[in] aMode 家の配置方法。PlacementMode_Legacy ならシード値ごとの配置は従来と同じです。
+void Stage::init(PlacementMode aMode)
 {
-    mTurn = 0;
-
-    // 農場の初期化
-    mOffice = Office(
+    initOfficeAndUFOs(
         Vector2(Parameter::StageWidth / 2.0f, Parameter::StageHeight / 2.0f)
         );
 
-    // UFOの初期化
-    // ステージ開始時はすべて農場の真上にいる
-    {
-        for (int i = 0; i < Parameter::LargeUFOCount; ++i) {
-            UFO ufo(
-                UFOType_Large,
-                mOffice.pos(),
-                float(Parameter::LargeUFORadius),
-                float(Parameter::LargeUFOMaxSpeed),
-                Parameter::LargeUFOCapacity
-                );
-
-            mUFOs.add(ufo);
-        }
-
-        for (int i = 0; i < Parameter::SmallUFOCount; ++i) {
-            UFO ufo(
-                UFOType_Small,
-                mOffice.pos(),
-                float(Parameter::SmallUFORadius),
-                float(Parameter::SmallUFOMaxSpeed),
-                Parameter::SmallUFOCapacity
-                );
-
-            mUFOs.add(ufo);
-        }
-    }
-
     const int MinTownCount = 2;
     const int MaxTownCount = 3;
     const int TownRadius = 100;
@@ -80,8 +243,8 @@ void Stage::init()
     int townCount = mRandom.randMinMax(MinTownCount, MaxTownCount);
     int randomHouseCount = mRandom.randMinMax(MinRandomHouseCount, MaxRandomHouseCount);
 
-    mRestItemCount = townCount * TownHouseCount + randomHouseCount;
-    HPC_MAX_ASSERT_I(mRestItemCount, Parameter::MaxHouseCount);
+    const int houseCount = townCount * TownHouseCount + randomHouseCount;
+    HPC_MAX_ASSERT_I(houseCount, Parameter::MaxHouseCount);
 
     // 家の配置
     {
@@ -134,25 +297,61 @@ void Stage::init()
                 break;
             }
 
+            // FreeCell 用: 街の中の各マスが選ばれる重み
+            // 中心からの距離と角度を一様乱数で決めるため、位置の密度は中心からの距離 r に対して 1/r に比例する。
+            // マスの重みはその密度をマスの範囲で積分したもの。
+            const float townReach = float(TownRadius - Parameter::HouseRadius);
+            const int townMinX = int(townCenter.x - townReach) / Parameter::HouseRadius;
+            const int townMinY = int(townCenter.y - townReach) / Parameter::HouseRadius;
+            const int townBoxSize = int(townReach * 2) / Parameter::HouseRadius + 2;
+            WeightedCellTree townCells(aMode == PlacementMode_FreeCell ? townBoxSize * townBoxSize : 0);
+            if (aMode == PlacementMode_FreeCell) {
+                std::vector<double> masses;
+                TownCellMasses(
+                    townMinX * Parameter::HouseRadius - townCenter.x,
+                    townMinY * Parameter::HouseRadius - townCenter.y,
+                    Parameter::HouseRadius,
+                    townBoxSize,
+                    townReach,
+                    masses
+                    );
+                for (int k = 0; k < townBoxSize * townBoxSize; ++k) {
+                    const int cellX = townMinX + k % townBoxSize;
+                    const int cellY = townMinY + k / townBoxSize;
+                    if (!placed[cellY][cellX]) {
+                        townCells.setWeight(k, int64_t(masses[k] * TownMassScale + 0.5));
+                    }
+                }
+            }
+
             for (int j = 0; j < TownHouseCount; ++j) {
                 // 配置済みの家に重ならない位置をランダムで探す
                 int gridX = -1;
                 int gridY = -1;
-                while (true) {
-                    float r = mRandom.randFloatTerm(TownRadius - Parameter::HouseRadius);
-                    float t = Math::PI * mRandom.randFloatTerm(2.0f);
-
-                    int posX = int(townCenter.x + r * Math::Cos(t));
-                    int posY = int(townCenter.y + r * Math::Sin(t));
-
-                    gridX = posX / Parameter::HouseRadius;
-                    gridY = posY / Parameter::HouseRadius;
-                    HPC_RANGE_ASSERT_MIN_UB_I(gridX, 0, GridWidth);
-                    HPC_RANGE_ASSERT_MIN_UB_I(gridY, 0, GridHeight);
-
-                    if (!placed[gridY][gridX]) {
-                        break;
+                if (aMode == PlacementMode_Legacy) {
+                    while (true) {
+                        float r = mRandom.randFloatTerm(TownRadius - Parameter::HouseRadius);
+                        float t = Math::PI * mRandom.randFloatTerm(2.0f);
+
+                        int posX = int(townCenter.x + r * Math::Cos(t));
+                        int posY = int(townCenter.y + r * Math::Sin(t));
+
+                        gridX = posX / Parameter::HouseRadius;
+                        gridY = posY / Parameter::HouseRadius;
+                        HPC_RANGE_ASSERT_MIN_UB_I(gridX, 0, GridWidth);
+                        HPC_RANGE_ASSERT_MIN_UB_I(gridY, 0, GridHeight);
+
+                        if (!placed[gridY][gridX]) {
+                            break;
+                        }
                     }
+                } else {
+                    // 空いているマスから重みに比例して選ぶ
+                    HPC_ASSERT(townCells.total() > 0);
+                    const int cell = townCells.find(RandTerm64(mRandom, townCells.total()));
+                    gridX = townMinX + cell % townBoxSize;
+                    gridY = townMinY + cell / townBoxSize;
+                    HPC_ASSERT(!placed[gridY][gridX]);
                 }
 
                 // 決定した位置の近辺のフラグを立てて、配置禁止にする
@@ -163,6 +362,15 @@ void Stage::init()
                     HPC_RANGE_ASSERT_MIN_UB_I(checkY, 0, GridHeight);
 
                     placed[checkY][checkX] = true;
+
+                    const int localX = checkX - townMinX;
+                    const int localY = checkY - townMinY;
+                    if (aMode == PlacementMode_FreeCell
+                        && 0 <= localX && localX < townBoxSize
+                        && 0 <= localY && localY < townBoxSize
+                        ) {
+                        townCells.setWeight(localY * townBoxSize + localX, 0);
+                    }
                 }
 
                 House house(
@@ -176,29 +384,89 @@ void Stage::init()
             }
         }
 
+        // FreeCell 用: バラバラに配置できるマスと、マスの中で条件を満たす座標の数
+        // 農場の近くを除く条件は座標で判定するため、境界のマスは一部の座標だけが有効。
+        const int CellPosCount = Parameter::HouseRadius * Parameter::HouseRadius;
+        FreeCellList fieldCells(aMode == PlacementMode_FreeCell ? GridWidth * GridHeight : 0);
+        std::vector<int> fieldPosCounts;
+        if (aMode == PlacementMode_FreeCell) {
+            fieldPosCounts.assign(GridWidth * GridHeight, 0);
+            // 座標の範囲がマスの境界にそろっていることを前提とする
+            static_assert(FieldMargin % Parameter::HouseRadius == 0, "invalid field margin");
+            const int cellMinX = FieldMargin / Parameter::HouseRadius;
+            const int cellMaxX = (Parameter::StageWidth - FieldMargin - 1) / Parameter::HouseRadius;
+            const int cellMinY = FieldMargin / Parameter::HouseRadius;
+            const int cellMaxY = (Parameter::StageHeight - FieldMargin - 1) / Parameter::HouseRadius;
+            // マスの中心から、マス内の座標までの最大距離 (に余裕を持たせたもの)
+            const float cellReach = float(Parameter::HouseRadius);
+            for (int cellY = cellMinY; cellY <= cellMaxY; ++cellY) {
+                for (int cellX = cellMinX; cellX <= cellMaxX; ++cellX) {
+                    const Vector2 cellCenter(
+                        (cellX + 0.5f) * Parameter::HouseRadius,
+                        (cellY + 0.5f) * Parameter::HouseRadius
+                        );
+                    const float distSq = cellCenter.squareDist(mOffice.pos());
+                    int& count = fieldPosCounts[cellY * GridWidth + cellX];
+                    if (distSq > (OfficeMargin + cellReach) * (OfficeMargin + cellReach)) {
+                        count = CellPosCount;
+                    } else if (distSq >= (OfficeMargin - cellReach) * (OfficeMargin - cellReach)) {
+                        // 農場の境界にかかるマスは座標ごとに判定する
+                        for (int dy = 0; dy < Parameter::HouseRadius; ++dy) {
+                            for (int dx = 0; dx < Parameter::HouseRadius; ++dx) {
+                                const int posX = cellX * Parameter::HouseRadius + dx;
+                                const int posY = cellY * Parameter::HouseRadius + dy;
+                                if (Vector2(float(posX), float(posY)).squareDist(mOffice.pos()) > OfficeMargin * OfficeMargin) {
+                                    ++count;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            for (int cell = 0; cell < GridWidth * GridHeight; ++cell) {
+                if (fieldPosCounts[cell] > 0 && !placed[cell / GridWidth][cell % GridWidth]) {
+                    fieldCells.add(cell);
+                }
+            }
+        }
+
         // バラバラに家を配置
         for (int i = 0; i < randomHouseCount; ++i) {
             // 配置済みの家に重ならない位置をランダムで探す
             int gridX = -1;
             int gridY = -1;
-            while (true) {
-                int posX = FieldMargin + mRandom.randTerm(Parameter::StageWidth - FieldMargin * 2);
-                int posY = FieldMargin + mRandom.randTerm(Parameter::StageHeight - FieldMargin * 2);
+            if (aMode == PlacementMode_Legacy) {
+                while (true) {
+                    int posX = FieldMargin + mRandom.randTerm(Parameter::StageWidth - FieldMargin * 2);
+                    int posY = FieldMargin + mRandom.randTerm(Parameter::StageHeight - FieldMargin * 2);
+
+                    gridX = posX / Parameter::HouseRadius;
+                    gridY = posY / Parameter::HouseRadius;
+                    HPC_RANGE_ASSERT_MIN_UB_I(gridX, 0, GridWidth);
+                    HPC_RANGE_ASSERT_MIN_UB_I(gridY, 0, GridHeight);
 
-                gridX = posX / Parameter::HouseRadius;
-                gridY = posY / Parameter::HouseRadius;
-                HPC_RANGE_ASSERT_MIN_UB_I(gridX, 0, GridWidth);
-                HPC_RANGE_ASSERT_MIN_UB_I(gridY, 0, GridHeight);
+                    if (placed[gridY][gridX]) {
+                        continue;
+                    }
 
-                if (placed[gridY][gridX]) {
-                    continue;
-                }
+                    if (Vector2(float(posX), float(posY)).squareDist(mOffice.pos()) <= OfficeMargin * OfficeMargin) {
+                        continue;
+                    }
 
-                if (Vector2(float(posX), float(posY)).squareDist(mOffice.pos()) <= OfficeMargin * OfficeMargin) {
-                    continue;
+                    break;
+                }
+            } else {
+                // 空きマスを一様に選び、有効な座標の割合で採否を決める
+                // やり直しになるのは農場の境界にかかるマスだけなので、空きマスが減っても回数は増えない
+                HPC_ASSERT(fieldCells.count() > 0);
+                while (true) {
+                    const int cell = fieldCells[mRandom.randTerm(fieldCells.count())];
+                    if (fieldPosCounts[cell] == CellPosCount || mRandom.randTerm(CellPosCount) < fieldPosCounts[cell]) {
+                        gridX = cell % GridWidth;
+                        gridY = cell / GridWidth;
+                        break;
+                    }
                 }
-
-                break;
             }
 
             // 決定した位置の近辺のフラグを立てて、配置禁止にする
@@ -209,6 +477,10 @@ void Stage::init()
                 HPC_RANGE_ASSERT_MIN_UB_I(checkY, 0, GridHeight);
 
                 placed[checkY][checkX] = true;
+
+                if (aMode == PlacementMode_FreeCell) {
+                    fieldCells.remove(checkY * GridWidth + checkX);
+                }
             }
 
             House house(
@@ -227,10 +499,11 @@ void Stage::init()
         int j = mRandom.randMinMax(0, i);
         std::swap(mHouses[i], mHouses[j]);
     }
+    mUndeliveredHouses = HouseSet::Range(mHouses.count());
 
 #if HEAVY_DEBUG
     // 家の数と配送が必要なアイテムの数が等しいこと
-    HPC_ASSERT(mRestItemCount == mHouses.count());
+    HPC_ASSERT(houseCount == mHouses.count());
 
     // 家が意図通りの配置かチェック
     for (auto& house : mHouses) {
@@ -258,9 +531,70 @@ void Stage::init()
 }
 
 //------------------------------------------------------------------------------
-void Stage::moveItems(const Actions& aActions)
+/// 与えられた配置でステージを初期化します。
+///
+/// ステージコーパスなど、生成器を通さずに作られたステージを使う場合に呼びます。
+///
+/// @param[in] aOfficePos 農場の位置。
+/// @param[in] aHousePositions 家の位置の配列。
+/// @param[in] aHouseCount 家の数。
+void Stage::init(const Vector2& aOfficePos, const Vector2* aHousePositions, int aHouseCount)
 {
+    HPC_RANGE_ASSERT_MIN_MAX_I(aHouseCount, 1, Parameter::MaxHouseCount);
+
+    initOfficeAndUFOs(aOfficePos);
+
+    for (int i = 0; i < aHouseCount; ++i) {
+        mHouses.add(House(aHousePositions[i]));
+    }
+    mUndeliveredHouses = HouseSet::Range(aHouseCount);
+}
+
+//------------------------------------------------------------------------------
+/// 農場とUFOを初期化します。
+void Stage::initOfficeAndUFOs(const Vector2& aOfficePos)
+{
+    mTurn = 0;
+
+    // 農場の初期化
+    mOffice = Office(aOfficePos);
+
+    // UFOの初期化
+    // ステージ開始時はすべて農場の真上にいる
+    {
+        for (int i = 0; i < Parameter::LargeUFOCount; ++i) {
+            UFO ufo(
+                UFOType_Large,
+                mOffice.pos(),
+                float(Parameter::LargeUFORadius),
+                float(Parameter::LargeUFOMaxSpeed),
+                Parameter::LargeUFOCapacity
+                );
+
+            mUFOs.add(ufo);
+        }
+
+        for (int i = 0; i < Parameter::SmallUFOCount; ++i) {
+            UFO ufo(
+                UFOType_Small,
+                mOffice.pos(),
+                float(Parameter::SmallUFORadius),
+                float(Parameter::SmallUFOMaxSpeed),
+                Parameter::SmallUFOCapacity
+                );
+
+            mUFOs.add(ufo);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/// @return 事前条件を満たさず、何も起こらなかった行動の数。
+int Stage::moveItems(const Actions& aActions)
+{
+    int rejectedCount = 0;
     for (auto& action: aActions) {
+        HPC_STATS_STAGE_ADD(issued[action.type()], 1);
         switch (action.type()) {
             case ActionType_PickUp:
             {
@@ -269,11 +603,14 @@ void Stage::moveItems(const Actions& aActions)
                 auto& ufo = mUFOs[action.ufoIndex()];
 
                 if (!Util::IsIntersect(mOffice, ufo)) {
+                    HPC_STATS_STAGE_ADD(rejected[ActionType_PickUp][RejectReason_NoIntersection], 1);
+                    ++rejectedCount;
                     continue;
                 }
 
                 int pickCount = ufo.capacity() - ufo.itemCount();
                 ufo.incItem(pickCount);
+                HPC_STATS_STAGE_ADD(pickedUp, 1);
 
                 break;
             }
@@ -286,6 +623,8 @@ void Stage::moveItems(const Actions& aActions)
                 auto& dstUFO = mUFOs[action.dstUFOIndex()];
 
                 if (!Util::IsIntersect(srcUFO, dstUFO)) {
+                    HPC_STATS_STAGE_ADD(rejected[ActionType_Pass][RejectReason_NoIntersection], 1);
+                    ++rejectedCount;
                     continue;
                 }
 
@@ -296,6 +635,7 @@ void Stage::moveItems(const Actions& aActions)
 
                 srcUFO.decItem(passCount);
                 dstUFO.incItem(passCount);
+                HPC_STATS_STAGE_ADD(passed, 1);
 
                 break;
             }
@@ -308,20 +648,27 @@ void Stage::moveItems(const Actions& aActions)
                 auto& house = mHouses[action.houseIndex()];
 
                 if (!Util::IsIntersect(ufo, house)) {
+                    HPC_STATS_STAGE_ADD(rejected[ActionType_Deliver][RejectReason_NoIntersection], 1);
+                    ++rejectedCount;
                     continue;
                 }
 
                 if (ufo.itemCount() == 0) {
+                    HPC_STATS_STAGE_ADD(rejected[ActionType_Deliver][RejectReason_EmptyUFO], 1);
+                    ++rejectedCount;
                     continue;
                 }
 
                 if (house.delivered()) {
+                    HPC_STATS_STAGE_ADD(rejected[ActionType_Deliver][RejectReason_AlreadyDelivered], 1);
+                    ++rejectedCount;
                     continue;
                 }
 
                 ufo.decItem(1);
                 house.deliver();
-                mRestItemCount--;
+                mUndeliveredHouses.remove(action.houseIndex());
+                HPC_STATS_STAGE_ADD(delivered[ufo.type()], 1);
 
                 break;
             }
@@ -329,6 +676,7 @@ void Stage::moveItems(const Actions& aActions)
                 HPC_SHOULD_NOT_REACH_HERE();
         }
     }
+    return rejectedCount;
 }
 
 //------------------------------------------------------------------------------
@@ -340,7 +688,16 @@ void Stage::moveUFOs(const TargetPositions& aTargetPositions)
         HPC_ASSERT(Math::IsValid(aTargetPositions[i].x));
         HPC_ASSERT(Math::IsValid(aTargetPositions[i].y));
 
+#ifdef HPC_STATS
+        const Vector2 lastPos = mUFOs[i].pos();
         mUFOs[i].move(aTargetPositions[i]);
+        HPC_STATS_STAGE_ADD(ufoTurns, 1);
+        if (mUFOs[i].pos() == lastPos) {
+            HPC_STATS_STAGE_ADD(idleUFOTurns, 1);
+        }
+#else
+        mUFOs[i].move(aTargetPositions[i]);
+#endif
     }
 }
 
@@ -353,7 +710,7 @@ void Stage::advanceTurn()
 //------------------------------------------------------------------------------
 bool Stage::hasFinished()const
 {
-    return mRestItemCount == 0;
+    return mUndeliveredHouses.isEmpty();
 }
 
 //------------------------------------------------------------------------------
@@ -380,5 +737,17 @@ const Houses& Stage::houses() const
     return mHouses;
 }
 
+//------------------------------------------------------------------------------
+HouseSet Stage::deliveredHouses() const
+{
+    return HouseSet::Range(mHouses.count()) - mUndeliveredHouses;
+}
+
+//------------------------------------------------------------------------------
+const HouseSet& Stage::undeliveredHouses() const
+{
+    return mUndeliveredHouses;
+}
+
 } // namespace
 // EOF
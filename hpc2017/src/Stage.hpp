@@ -15,7 +15,9 @@
 #include "Office.hpp"
 #include "UFO.hpp"
 #include "House.hpp"
+#include "HouseSet.hpp"
 #include "Array.hpp"
+#include "PlacementMode.hpp"
 
 namespace hpc {
 
@@ -32,8 +34,9 @@ public:
     /// @name 内部用関数。
     //@{
     Stage(RandomSeed aSeed);
-    void init();
-    void moveItems(const Actions& aActions);
+    void init(PlacementMode aMode = PlacementMode_Legacy);
+    void init(const Vector2& aOfficePos, const Vector2* aHousePositions, int aHouseCount);
+    int moveItems(const Actions& aActions);
     void moveUFOs(const TargetPositions& aTargetPositions);
     void advanceTurn();
     bool hasFinished()const;
@@ -45,10 +48,14 @@ public:
     const Office& office()const; ///< 農場を取得します。
     const UFOs& ufos()const;     ///< UFOの配列を取得します。
     const Houses& houses()const; ///< 家の配列を取得します。
+    HouseSet deliveredHouses()const;         ///< 配達済みの家の集合を取得します。
+    const HouseSet& undeliveredHouses()const; ///< 未配達の家の集合を取得します。
     //@}
 private:
+    void initOfficeAndUFOs(const Vector2& aOfficePos);
+
     int mTurn;
-    int mRestItemCount;
+    HouseSet mUndeliveredHouses;
     Office mOffice;
     UFOs mUFOs;
     Houses mHouses;
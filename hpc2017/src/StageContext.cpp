@@ -0,0 +1,41 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "StageContext.hpp"
+
+namespace hpc {
+
+namespace {
+
+/// このスレッドで実行中のステージの番号。設定されていなければ -1。
+thread_local int tStageIndex = -1;
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/// このスレッドで実行するステージの番号を設定します。
+///
+/// @param[in] aStageIndex ステージの番号。-k で読み飛ばした分も数えます。
+void StageContext::SetIndex(int aStageIndex)
+{
+    tStageIndex = aStageIndex;
+}
+
+//------------------------------------------------------------------------------
+/// このスレッドで実行中のステージの番号を取得します。
+///
+/// @return ステージの番号。Game の外で呼ばれたときは -1。
+int StageContext::Index()
+{
+    return tStageIndex;
+}
+
+} // namespace
+// EOF
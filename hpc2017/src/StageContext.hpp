@@ -0,0 +1,29 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// 実行中のステージの情報。
+///
+/// Game が解答の init を呼ぶ前に、そのスレッドに設定します。
+/// 値はスレッドごとに持つので、-t のワーカーでもそれぞれのステージの番号が取れます。
+/// 提出する解答からは使えないので、解答は LOCAL の時だけ使います。
+class StageContext
+{
+public:
+    static void SetIndex(int aStageIndex);  ///< このスレッドで実行するステージの番号を設定します。
+    static int Index();                     ///< このスレッドで実行中のステージの番号を取得します。
+};
+
+} // namespace
+// EOF
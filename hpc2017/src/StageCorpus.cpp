@@ -0,0 +1,247 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+#include "StageCorpus.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Assert.hpp"
+
+namespace hpc {
+
+static_assert(sizeof(StageCorpusFormat::Header) == 16, "invalid header size");
+static_assert(sizeof(StageCorpusFormat::Record) % 4 == 0, "invalid record size");
+
+//------------------------------------------------------------------------------
+/// StageCorpus クラスのインスタンスを生成します。
+StageCorpus::StageCorpus()
+: mData(nullptr)
+, mSize(0)
+, mStageCount(0)
+{
+}
+
+//------------------------------------------------------------------------------
+/// StageCorpus クラスのインスタンスを破棄します。
+StageCorpus::~StageCorpus()
+{
+    close();
+}
+
+//------------------------------------------------------------------------------
+/// コーパスファイルを開きます。
+///
+/// @param[in] aPath コーパスファイルのパス。
+/// @return 開くことができ、形式が正しければ true を返します。
+bool StageCorpus::open(const char* aPath)
+{
+    close();
+
+    int fd = ::open(aPath, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(StageCorpusFormat::Header)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* data = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // マップした領域はファイルを閉じても有効
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    const auto& header = *static_cast<const StageCorpusFormat::Header*>(data);
+    const size_t expectSize = sizeof(StageCorpusFormat::Header)
+        + size_t(header.stageCount) * sizeof(StageCorpusFormat::Record);
+    if (header.magic != StageCorpusFormat::Magic
+        || header.version != StageCorpusFormat::Version
+        || header.recordSize != sizeof(StageCorpusFormat::Record)
+        || size_t(st.st_size) != expectSize
+        ) {
+        ::munmap(data, size_t(st.st_size));
+        return false;
+    }
+
+    // ステージは順に読むので、先読みを促す
+    ::madvise(data, size_t(st.st_size), MADV_SEQUENTIAL);
+
+    mData = data;
+    mSize = size_t(st.st_size);
+    mStageCount = int(header.stageCount);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// コーパスファイルを閉じます。
+void StageCorpus::close()
+{
+    if (mData != nullptr) {
+        ::munmap(mData, mSize);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mStageCount = 0;
+}
+
+//------------------------------------------------------------------------------
+/// コーパスファイルを開いているかを取得します。
+bool StageCorpus::isOpen()const
+{
+    return mData != nullptr;
+}
+
+//------------------------------------------------------------------------------
+/// ステージ数を取得します。
+int StageCorpus::stageCount()const
+{
+    return mStageCount;
+}
+
+//------------------------------------------------------------------------------
+/// ステージを初期化します。
+///
+/// @param[in] aIndex ステージの番号。
+/// @param[out] aStage 初期化するステージ。
+void StageCorpus::initStage(int aIndex, Stage& aStage)const
+{
+    const StageCorpusFormat::Record& rec = record(aIndex);
+
+    HPC_RANGE_ASSERT_MIN_MAX_I(int(rec.houseCount), 1, Parameter::MaxHouseCount);
+
+    Vector2 housePositions[Parameter::MaxHouseCount];
+    for (int i = 0; i < rec.houseCount; ++i) {
+        housePositions[i] = Vector2(float(rec.housePos[i][0]), float(rec.housePos[i][1]));
+    }
+
+    aStage.init(Vector2(float(rec.officeX), float(rec.officeY)), housePositions, rec.houseCount);
+}
+
+//------------------------------------------------------------------------------
+/// 参照ターン数を取得します。
+///
+/// @return 参照ターン数。記録されていなければ StageCorpusFormat::NoReferenceTurn を返します。
+int StageCorpus::referenceTurn(int aIndex)const
+{
+    return record(aIndex).referenceTurn;
+}
+
+//------------------------------------------------------------------------------
+/// すべてのステージに参照ターン数があるかを取得します。
+bool StageCorpus::hasReferenceTurns()const
+{
+    for (int i = 0; i < mStageCount; ++i) {
+        if (referenceTurn(i) == StageCorpusFormat::NoReferenceTurn) {
+            return false;
+        }
+    }
+    return mStageCount != 0;
+}
+
+//------------------------------------------------------------------------------
+/// ステージのレコードを取得します。
+const StageCorpusFormat::Record& StageCorpus::record(int aIndex)const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, mStageCount);
+
+    const char* records = static_cast<const char*>(mData) + sizeof(StageCorpusFormat::Header);
+    return reinterpret_cast<const StageCorpusFormat::Record*>(records)[aIndex];
+}
+
+//------------------------------------------------------------------------------
+/// StageCorpusWriter クラスのインスタンスを生成します。
+StageCorpusWriter::StageCorpusWriter()
+: mFile(nullptr)
+, mStageCount(0)
+{
+}
+
+//------------------------------------------------------------------------------
+/// StageCorpusWriter クラスのインスタンスを破棄します。
+StageCorpusWriter::~StageCorpusWriter()
+{
+    close();
+}
+
+//------------------------------------------------------------------------------
+/// コーパスファイルを作成します。
+///
+/// @param[in] aPath コーパスファイルのパス。既にあれば上書きします。
+bool StageCorpusWriter::open(const char* aPath)
+{
+    close();
+
+    mFile = std::fopen(aPath, "wb");
+    if (mFile == nullptr) {
+        return false;
+    }
+    mStageCount = 0;
+
+    // ステージ数は close() で確定する
+    StageCorpusFormat::Header header = {};
+    return std::fwrite(&header, sizeof(header), 1, mFile) == 1;
+}
+
+//------------------------------------------------------------------------------
+/// ステージを追加します。
+///
+/// @param[in] aStage 初期化済みのステージ。
+/// @param[in] aReferenceTurn 参照ターン数。なければ StageCorpusFormat::NoReferenceTurn。
+bool StageCorpusWriter::add(const Stage& aStage, int aReferenceTurn)
+{
+    HPC_ASSERT(mFile != nullptr);
+
+    StageCorpusFormat::Record rec;
+    std::memset(&rec, 0, sizeof(rec));
+    rec.officeX = uint16_t(aStage.office().pos().x);
+    rec.officeY = uint16_t(aStage.office().pos().y);
+    rec.houseCount = uint16_t(aStage.houses().count());
+    rec.referenceTurn = aReferenceTurn;
+    for (int i = 0; i < aStage.houses().count(); ++i) {
+        rec.housePos[i][0] = uint16_t(aStage.houses()[i].pos().x);
+        rec.housePos[i][1] = uint16_t(aStage.houses()[i].pos().y);
+    }
+
+    if (std::fwrite(&rec, sizeof(rec), 1, mFile) != 1) {
+        return false;
+    }
+    ++mStageCount;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// ヘッダを確定してファイルを閉じます。
+bool StageCorpusWriter::close()
+{
+    if (mFile == nullptr) {
+        return true;
+    }
+
+    StageCorpusFormat::Header header;
+    header.magic = StageCorpusFormat::Magic;
+    header.version = StageCorpusFormat::Version;
+    header.stageCount = uint32_t(mStageCount);
+    header.recordSize = sizeof(StageCorpusFormat::Record);
+
+    bool ok = std::fseek(mFile, 0, SEEK_SET) == 0
+        && std::fwrite(&header, sizeof(header), 1, mFile) == 1;
+    ok = std::fclose(mFile) == 0 && ok;
+    mFile = nullptr;
+    return ok;
+}
+
+} // namespace
+// EOF
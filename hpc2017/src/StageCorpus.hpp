@@ -0,0 +1,98 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include "Parameter.hpp"
+#include "Stage.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// ステージコーパスのファイル形式。
+///
+/// ファイルはヘッダと、ステージごとの固定長レコードの並びです。
+/// レコードが固定長なので、任意のステージに O(1) でアクセスできます。
+/// 値はすべてリトルエンディアンで、座標は整数に丸めて保存します。
+/// (生成器が作るステージの座標はすべて整数です)
+struct StageCorpusFormat
+{
+    static const uint32_t Magic = 0x53435048;   ///< "HPCS"
+    static const uint32_t Version = 1;          ///< 形式のバージョン
+    static const int32_t NoReferenceTurn = -1;  ///< 参照ターン数がないことを表す値
+
+    /// ファイルの先頭。
+    struct Header
+    {
+        uint32_t magic;         ///< Magic
+        uint32_t version;       ///< Version
+        uint32_t stageCount;    ///< ステージ数
+        uint32_t recordSize;    ///< 1ステージのレコードのバイト数
+    };
+
+    /// 1ステージ分のレコード。
+    struct Record
+    {
+        uint16_t officeX;                                  ///< 農場の x 座標
+        uint16_t officeY;                                  ///< 農場の y 座標
+        uint16_t houseCount;                               ///< 家の数
+        uint16_t reserved;                                 ///< 予約領域 (0)
+        int32_t referenceTurn;                             ///< 参照ターン数 (なければ NoReferenceTurn)
+        uint16_t housePos[Parameter::MaxHouseCount][2];    ///< 家の座標 (x, y)
+    };
+};
+
+//------------------------------------------------------------------------------
+/// ステージコーパスの読み込み。
+///
+/// ファイルを mmap して、ステージを必要になった時点で1つずつ取り出します。
+class StageCorpus
+{
+public:
+    StageCorpus();
+    ~StageCorpus();
+    bool open(const char* aPath);                      ///< コーパスファイルを開きます。
+    void close();                                      ///< コーパスファイルを閉じます。
+    bool isOpen()const;                                ///< コーパスファイルを開いているかを取得します。
+    int stageCount()const;                             ///< ステージ数を取得します。
+    void initStage(int aIndex, Stage& aStage)const;    ///< ステージを初期化します。
+    int referenceTurn(int aIndex)const;                ///< 参照ターン数を取得します。
+    bool hasReferenceTurns()const;                     ///< すべてのステージに参照ターン数があるかを取得します。
+private:
+    StageCorpus(const StageCorpus&);
+    StageCorpus& operator=(const StageCorpus&);
+    const StageCorpusFormat::Record& record(int aIndex)const;
+
+    void* mData;                                       ///< mmap した領域
+    size_t mSize;                                      ///< mmap した領域のバイト数
+    int mStageCount;                                   ///< ステージ数
+};
+
+//------------------------------------------------------------------------------
+/// ステージコーパスの書き出し。
+class StageCorpusWriter
+{
+public:
+    StageCorpusWriter();
+    ~StageCorpusWriter();
+    bool open(const char* aPath);                      ///< コーパスファイルを作成します。
+    bool add(const Stage& aStage, int aReferenceTurn); ///< ステージを追加します。
+    bool close();                                      ///< ヘッダを確定してファイルを閉じます。
+private:
+    StageCorpusWriter(const StageCorpusWriter&);
+    StageCorpusWriter& operator=(const StageCorpusWriter&);
+
+    std::FILE* mFile;                                  ///< 書き出し先
+    int mStageCount;                                   ///< 書き出したステージ数
+};
+
+} // namespace
+// EOF
@@ -0,0 +1,116 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "Stats.hpp"
+
+#include "Print.hpp"
+
+namespace hpc {
+
+namespace {
+
+//------------------------------------------------------------------------------
+/// ステージの出来事の回数を出力します。
+void PrintStageCounters(const char* aTitle, const StageCounters& aCounters)
+{
+    static const char* const ActionNames[ActionType_TERM] = { "PickUp", "Pass", "Deliver" };
+
+    HPC_PRINTF("[%s]\n", aTitle);
+    HPC_PRINTF("action  |       issued |     rejected | noIntersect |  emptyUFO | alreadyDelivered\n");
+    for (int type = 0; type < ActionType_TERM; ++type) {
+        long long rejected = 0;
+        for (int reason = 0; reason < RejectReason_TERM; ++reason) {
+            rejected += aCounters.rejected[type][reason];
+        }
+        HPC_PRINTF("%-7s | %12lld | %12lld | %11lld | %9lld | %16lld\n",
+            ActionNames[type],
+            aCounters.issued[type],
+            rejected,
+            aCounters.rejected[type][RejectReason_NoIntersection],
+            aCounters.rejected[type][RejectReason_EmptyUFO],
+            aCounters.rejected[type][RejectReason_AlreadyDelivered]);
+    }
+    HPC_PRINTF("PickedUp: %lld\n", aCounters.pickedUp);
+    HPC_PRINTF("Passed: %lld\n", aCounters.passed);
+    HPC_PRINTF("Delivered: large %lld, small %lld\n",
+        aCounters.delivered[UFOType_Large], aCounters.delivered[UFOType_Small]);
+    HPC_PRINTF("IdleUFOTurns: %lld / %lld\n", aCounters.idleUFOTurns, aCounters.ufoTurns);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/// インスタンスを取得します。
+///
+/// スレッドごとに別のインスタンスです。
+Stats& Stats::Instance()
+{
+    static thread_local Stats stats;
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+/// 記録が有効なビルドかを取得します。
+bool Stats::IsEnabled()
+{
+#ifdef HPC_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/// Stats クラスのインスタンスを生成します。
+Stats::Stats()
+: game()
+, simulation()
+, isInGame(false)
+, stageCount(0)
+, rollouts(0)
+, prunedRollouts(0)
+, simulatedTurns(0)
+, macroSteps(0)
+, macroTurns(0)
+{
+}
+
+//------------------------------------------------------------------------------
+/// 現在記録しているステージの出来事の回数を取得します。
+StageCounters& Stats::current()
+{
+    return isInGame ? game : simulation;
+}
+
+//------------------------------------------------------------------------------
+/// 統計を出力します。
+void Stats::print()const
+{
+    if (!IsEnabled()) {
+        HPC_PRINTF("Stats: disabled. Build with STATS=1 to record them.\n");
+        return;
+    }
+
+    PrintStageCounters("game", game);
+    PrintStageCounters("simulation", simulation);
+
+    const double stages = stageCount > 0 ? double(stageCount) : 1.0;
+    HPC_PRINTF("[solver]\n");
+    HPC_PRINTF("Rollouts: %lld (%.1f per stage)\n", rollouts, rollouts / stages);
+    HPC_PRINTF("PrunedRollouts: %lld (%.1f per stage)\n", prunedRollouts, prunedRollouts / stages);
+    HPC_PRINTF("SimulatedTurns: %lld (%.1f per stage)\n", simulatedTurns, simulatedTurns / stages);
+    // 判断を行ったターンと、まとめて進めた回数の和が、判断の回数
+    const long long steps = simulatedTurns - macroTurns + macroSteps;
+    HPC_PRINTF("MacroSteps: %lld (%lld turns, %.1f turns per step)\n", macroSteps, macroTurns, macroTurns / (macroSteps > 0 ? double(macroSteps) : 1.0));
+    HPC_PRINTF("SimulationSteps: %lld (%.2f turns per step)\n", steps, simulatedTurns / (steps > 0 ? double(steps) : 1.0));
+}
+
+} // namespace
+// EOF
@@ -0,0 +1,89 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include "ActionType.hpp"
+#include "UFOType.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// 行動が何も起こさなかった理由。
+enum RejectReason
+{
+    RejectReason_NoIntersection,    ///< 農場・UFO・家が重なっていない。
+    RejectReason_EmptyUFO,          ///< UFOが箱を持っていない。
+    RejectReason_AlreadyDelivered,  ///< 家が配達済み状態である。
+
+    RejectReason_TERM,
+};
+
+//------------------------------------------------------------------------------
+/// ステージで起きた出来事の回数。
+struct StageCounters
+{
+    long long issued[ActionType_TERM];                      ///< 指定された行動の数
+    long long rejected[ActionType_TERM][RejectReason_TERM]; ///< 何も起こさなかった行動の数
+    long long pickedUp;                                     ///< 積み込みの回数
+    long long passed;                                       ///< 受け渡しの回数
+    long long delivered[UFOType_TERM];                      ///< UFOの種類ごとの配達数
+    long long ufoTurns;                                     ///< UFOごとのターン数の合計
+    long long idleUFOTurns;                                 ///< そのうち、移動しなかったターン数
+};
+
+//------------------------------------------------------------------------------
+/// 実行中の出来事の回数の統計。
+///
+/// HPC_STATS を定義してビルドしたときだけ記録します。
+/// 定義していなければ記録用のマクロは何も展開しないので、実行速度に影響しません。
+/// ステージへの操作は、ゲームとしての操作と解答内のシミュレーションとを分けて数えます。
+class Stats
+{
+public:
+    static Stats& Instance();       ///< スレッドごとのインスタンスを取得します。
+    static bool IsEnabled();        ///< 記録が有効なビルドかを取得します。
+
+    StageCounters& current();       ///< 現在記録しているステージの出来事の回数を取得します。
+    void print()const;              ///< 統計を出力します。
+
+    StageCounters game;             ///< ゲームとしての操作
+    StageCounters simulation;       ///< 解答内のシミュレーションでの操作
+    bool isInGame;                  ///< ゲームとしての操作中か
+    long long stageCount;           ///< 実行したステージ数
+    long long rollouts;             ///< 解答が試したロールアウトの数
+    long long prunedRollouts;       ///< そのうち、下界で打ち切ったロールアウトの数
+    long long simulatedTurns;       ///< 解答がシミュレーションしたターン数
+    long long macroSteps;           ///< 受け渡しの起きないターンをまとめて進めた回数
+    long long macroTurns;           ///< そのうちまとめて進めたターン数
+
+private:
+    Stats();
+};
+
+} // namespace
+
+#ifdef HPC_STATS
+/// 統計の値に加算します。
+#define HPC_STATS_ADD(aCounter, aValue) \
+    do { ::hpc::Stats::Instance().aCounter += (aValue); } while(false)
+/// 現在記録しているステージの出来事の回数に加算します。
+#define HPC_STATS_STAGE_ADD(aCounter, aValue) \
+    do { ::hpc::Stats::Instance().current().aCounter += (aValue); } while(false)
+/// ゲームとしての操作中かを設定します。
+#define HPC_STATS_SET_IN_GAME(aValue) \
+    do { ::hpc::Stats::Instance().isInGame = (aValue); } while(false)
+#else
+#define HPC_STATS_ADD(aCounter, aValue) do {} while(false)
+#define HPC_STATS_STAGE_ADD(aCounter, aValue) do {} while(false)
+#define HPC_STATS_SET_IN_GAME(aValue) do {} while(false)
+#endif
+
+// EOF
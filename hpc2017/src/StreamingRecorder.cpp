@@ -0,0 +1,134 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "StreamingRecorder.hpp"
+
+#include <cstdio>
+#include "Assert.hpp"
+#include "Print.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// StreamingRecorder クラスのインスタンスを生成します。
+StreamingRecorder::StreamingRecorder()
+: mStageRecord()
+, mStageTurns()
+, mTotalTurn(0)
+, mCurrentTurn(0)
+, mHasWrittenHeader(false)
+{
+}
+
+//------------------------------------------------------------------------------
+/// 結果を出力します。
+///
+/// ログは実行中に書き出し済みなので、Recorder::dumpResult() と同じ概要だけを出力します。
+void StreamingRecorder::dumpResult(bool aIsSilent)const
+{
+    if (!aIsSilent) {
+        HPC_PRINTF("stage | turn\n");
+        for(int i = 0; i < stageCount(); ++i) {
+            HPC_PRINTF("% 5d | % 4d\n", i, stageTurn(i));
+        }
+    }
+    HPC_PRINTF("TotalTurn: %d\n", mTotalTurn);
+}
+
+//------------------------------------------------------------------------------
+/// ステージの初期化後に実行される関数。
+void StreamingRecorder::afterInitStage(const Stage& aStage)
+{
+    writeHeader();
+    mCurrentTurn = 0;
+    Recorder::WriteStageRecord(mStageRecord, aStage);
+}
+
+//------------------------------------------------------------------------------
+/// ターンを進めた後に実行される関数。
+void StreamingRecorder::afterAdvanceTurn(const Stage& aStage)
+{
+    ++mCurrentTurn;
+    Recorder::WriteTurnRecord(mStageRecord.turnRecords[mCurrentTurn], aStage);
+}
+
+//------------------------------------------------------------------------------
+/// ステージが終了した後に実行される関数。
+///
+/// ステージのログを1行で書き出します。
+void StreamingRecorder::afterFinishStage()
+{
+    mStageRecord.turn = mCurrentTurn;
+    Recorder::DumpJsonStage(mStageRecord);
+    HPC_PRINTF("\n");
+    std::fflush(stdout);
+
+    mStageTurns.push_back(mCurrentTurn);
+    mTotalTurn += mCurrentTurn;
+}
+
+//------------------------------------------------------------------------------
+/// 全ステージが終了した後に実行される関数。
+///
+/// 最終行に合計ターン数を書き出します。
+void StreamingRecorder::afterFinishAllStages()
+{
+    writeHeader();
+    HPC_PRINTF("%d\n", mTotalTurn);
+}
+
+//------------------------------------------------------------------------------
+/// ターンごとの記録をせずに、ステージのターン数だけを記録します。
+///
+/// ステージのログは書き出さないので、並列実行とは併用できません。
+void StreamingRecorder::addStageTurn(int aTurn)
+{
+    mStageTurns.push_back(aTurn);
+    mTotalTurn += aTurn;
+}
+
+//------------------------------------------------------------------------------
+/// 総ターン数を取得します。
+int StreamingRecorder::totalTurn()const
+{
+    return mTotalTurn;
+}
+
+//------------------------------------------------------------------------------
+/// 記録したステージ数を取得します。
+int StreamingRecorder::stageCount()const
+{
+    return int(mStageTurns.size());
+}
+
+//------------------------------------------------------------------------------
+/// ステージのターン数を取得します。
+///
+/// @param[in] aStageNumber ステージの番号。
+int StreamingRecorder::stageTurn(int aStageNumber)const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(aStageNumber, 0, stageCount());
+    return mStageTurns[aStageNumber];
+}
+
+//------------------------------------------------------------------------------
+/// 1行目の定数情報をまだ書いていなければ書き出します。
+void StreamingRecorder::writeHeader()
+{
+    if (mHasWrittenHeader) {
+        return;
+    }
+    Recorder::DumpJsonParameters();
+    HPC_PRINTF("\n");
+    mHasWrittenHeader = true;
+}
+
+} // namespace
+// EOF
@@ -0,0 +1,54 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include "Recorder.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// ステージが終わるたびに、ログを1行の Json として標準出力に書き出すログ記録器。
+///
+/// Recorder と同じ関数を持ち、Game の記録器として使えます。
+/// 記録を持つのは実行中の1ステージだけなので、ステージ数が多くてもメモリは増えません。
+///
+/// 出力は1行に1つの Json です。(JSON Lines)
+/// - 1行目: 定数情報。Recorder::dumpJson() の2番目の要素と同じです。
+/// - 続く各行: ステージのログ。Recorder::dumpJson() のステージの要素と同じです。
+/// - 最終行: 合計ターン数。
+class StreamingRecorder
+{
+public:
+    StreamingRecorder();
+    void dumpResult(bool aIsSilent)const;        ///< 結果を出力します。
+
+    void afterInitStage(const Stage& aStage);    ///< ステージの初期化後に実行される関数。
+    void afterAdvanceTurn(const Stage& aStage);  ///< ターンを進めた後に実行される関数。
+    void afterFinishStage();                     ///< ステージが終了した後に実行される関数。
+    void afterFinishAllStages();                 ///< 全ステージが終了した後に実行される関数。
+    void addStageTurn(int aTurn);                ///< ターンごとの記録をせずに、ステージのターン数だけを記録します。
+
+    int totalTurn()const;                        ///< 総ターン数を取得します。
+    int stageCount()const;                       ///< 記録したステージ数を取得します。
+    int stageTurn(int aStageNumber)const;        ///< ステージのターン数を取得します。
+private:
+    void writeHeader();                          ///< 1行目の定数情報をまだ書いていなければ書き出します。
+
+    Recorder::StageRecord mStageRecord;          ///< 実行中のステージの記録
+    std::vector<int> mStageTurns;                ///< ステージごとのターン数
+    int mTotalTurn;                              ///< 総ターン数
+    int mCurrentTurn;                            ///< 現在記録しているターン数
+    bool mHasWrittenHeader;                      ///< 定数情報を書き出したか
+};
+
+} // namespace
+// EOF
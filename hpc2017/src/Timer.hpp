@@ -27,5 +27,17 @@ private:
     std::clock_t mTimeEnd;      ///< 終了時刻
 };
 
+//------------------------------------------------------------------------------
+/// 何も計測しないタイマー。
+///
+/// Timer と同じ関数を持ち、時間を使わないベンチマークなどで Game のタイマーとして使います。
+class NullTimer
+{
+public:
+    void start() {}                             ///< 何もしません。
+    void stop() {}                              ///< 何もしません。
+    double elapsedSec()const { return 0.0; }    ///< 常に 0 を返します。
+};
+
 } // namespace
 // EOF
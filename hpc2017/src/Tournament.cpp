@@ -0,0 +1,203 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "Tournament.hpp"
+
+#include <cmath>
+#include <cstring>
+#include "Assert.hpp"
+#include "Print.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// Tournament クラスのインスタンスを生成します。
+Tournament::Tournament()
+: mEntries()
+, mStageCount(0)
+, mTurns()
+, mSecs()
+{
+}
+
+//------------------------------------------------------------------------------
+/// 解答とステージ数を設定し、結果を消去します。
+///
+/// @param[in] aEntries 比べる解答。先頭の解答が基準になります。
+/// @param[in] aStageCount 実行するステージ数。
+void Tournament::reset(const std::vector<const AnswerEntry*>& aEntries, int aStageCount)
+{
+    HPC_ASSERT(!aEntries.empty());
+    HPC_MIN_ASSERT_I(aStageCount, 0);
+    mEntries = aEntries;
+    mStageCount = aStageCount;
+    mTurns.assign(mEntries.size() * aStageCount, 0);
+    mSecs.assign(mEntries.size() * aStageCount, 0.0);
+}
+
+//------------------------------------------------------------------------------
+/// 解答の数を取得します。
+int Tournament::variantCount()const
+{
+    return int(mEntries.size());
+}
+
+//------------------------------------------------------------------------------
+/// ステージ数を取得します。
+int Tournament::stageCount()const
+{
+    return mStageCount;
+}
+
+//------------------------------------------------------------------------------
+/// 解答を取得します。
+const AnswerEntry& Tournament::entry(int aVariant)const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(aVariant, 0, variantCount());
+    return *mEntries[aVariant];
+}
+
+//------------------------------------------------------------------------------
+/// ステージの結果を記録します。
+///
+/// @param[in] aVariant 解答の番号。
+/// @param[in] aStage ステージの番号。
+/// @param[in] aTurn ステージのターン数。
+/// @param[in] aSec ステージに掛かった CPU 時間 (秒)。
+void Tournament::setResult(int aVariant, int aStage, int aTurn, double aSec)
+{
+    mTurns[index(aVariant, aStage)] = aTurn;
+    mSecs[index(aVariant, aStage)] = aSec;
+}
+
+//------------------------------------------------------------------------------
+/// ステージのターン数を取得します。
+int Tournament::turn(int aVariant, int aStage)const
+{
+    return mTurns[index(aVariant, aStage)];
+}
+
+//------------------------------------------------------------------------------
+/// 総ターン数を取得します。
+int Tournament::totalTurn(int aVariant)const
+{
+    int total = 0;
+    for (int i = 0; i < mStageCount; ++i) {
+        total += turn(aVariant, i);
+    }
+    return total;
+}
+
+//------------------------------------------------------------------------------
+/// 解答に掛かった CPU 時間の合計を取得します。
+double Tournament::totalSec(int aVariant)const
+{
+    double total = 0.0;
+    for (int i = 0; i < mStageCount; ++i) {
+        total += mSecs[index(aVariant, i)];
+    }
+    return total;
+}
+
+//------------------------------------------------------------------------------
+/// 基準の解答と対比較します。
+///
+/// 同じステージのターン数の差 (aVariant - 基準) を標本として、対応のある t 検定を行います。
+/// ステージ数は十分に多いものとして、信頼区間と p 値には正規分布の近似を使います。
+///
+/// @param[in] aVariant 比べる解答の番号。
+Tournament::Comparison Tournament::compare(int aVariant)const
+{
+    Comparison result = {};
+    double sum = 0.0;
+    for (int i = 0; i < mStageCount; ++i) {
+        const int diff = turn(aVariant, i) - turn(0, i);
+        sum += diff;
+        if (diff < 0) {
+            ++result.winCount;
+        } else if (diff > 0) {
+            ++result.lossCount;
+        } else {
+            ++result.tieCount;
+        }
+    }
+    if (mStageCount == 0) {
+        result.pValue = 1.0;
+        return result;
+    }
+    result.meanDiff = sum / mStageCount;
+
+    double squareSum = 0.0;
+    for (int i = 0; i < mStageCount; ++i) {
+        const double dev = (turn(aVariant, i) - turn(0, i)) - result.meanDiff;
+        squareSum += dev * dev;
+    }
+    result.stdDev = mStageCount > 1 ? std::sqrt(squareSum / (mStageCount - 1)) : 0.0;
+
+    const double stdError = result.stdDev / std::sqrt(double(mStageCount));
+    result.halfWidth95 = 1.96 * stdError;
+    if (stdError > 0.0) {
+        result.tValue = result.meanDiff / stdError;
+        result.pValue = std::erfc(std::fabs(result.tValue) / std::sqrt(2.0));
+    } else {
+        // 全ステージで差が同じ
+        result.pValue = result.meanDiff == 0.0 ? 1.0 : 0.0;
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/// 結果を出力します。
+///
+/// ステージごとのターン数、解答ごとの総ターン数と CPU 時間、基準との対比較の順に出力します。
+///
+/// @param[in] aIsSilent ステージごとの行を出力しないか。
+void Tournament::print(bool aIsSilent)const
+{
+    if (!aIsSilent) {
+        HPC_PRINTF("stage");
+        for (int v = 0; v < variantCount(); ++v) {
+            HPC_PRINTF(" | %s", entry(v).name);
+        }
+        HPC_PRINTF("\n");
+        for (int i = 0; i < mStageCount; ++i) {
+            HPC_PRINTF("% 5d", i);
+            for (int v = 0; v < variantCount(); ++v) {
+                HPC_PRINTF(" | % *d", int(std::strlen(entry(v).name)), turn(v, i));
+            }
+            HPC_PRINTF("\n");
+        }
+    }
+
+    HPC_PRINTF("Stages: %d\n", mStageCount);
+    for (int v = 0; v < variantCount(); ++v) {
+        HPC_PRINTF("%s: TotalTurn: %d Time: %.3f sec\n", entry(v).name, totalTurn(v), totalSec(v));
+    }
+    for (int v = 1; v < variantCount(); ++v) {
+        const Comparison result = compare(v);
+        HPC_PRINTF("%s - %s: %+.3f turn/stage (95%% CI %+.3f .. %+.3f) sd %.3f t %+.2f p %.4f win/loss/tie %d/%d/%d\n",
+            entry(v).name, entry(0).name,
+            result.meanDiff, result.meanDiff - result.halfWidth95, result.meanDiff + result.halfWidth95,
+            result.stdDev, result.tValue, result.pValue,
+            result.winCount, result.lossCount, result.tieCount);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// 結果の配列の添字を取得します。
+int Tournament::index(int aVariant, int aStage)const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(aVariant, 0, variantCount());
+    HPC_RANGE_ASSERT_MIN_UB_I(aStage, 0, mStageCount);
+    return aVariant * mStageCount + aStage;
+}
+
+} // namespace
+// EOF
@@ -0,0 +1,61 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+#include "AnswerRegistry.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// 複数の解答を同じステージで実行した結果。
+///
+/// 最初の解答を基準に、ステージごとのターン数の差を対にして比べます。
+/// 結果は解答とステージの組ごとに別の要素に書くので、
+/// 違う組であればワーカースレッドから同時に setResult() を呼び出せます。
+class Tournament
+{
+public:
+    /// 基準の解答との対比較の結果。
+    struct Comparison
+    {
+        double meanDiff;        ///< ステージあたりのターン数の差の平均 (負なら基準より良い)
+        double stdDev;          ///< 差の標本標準偏差
+        double halfWidth95;     ///< 平均の 95% 信頼区間の半幅
+        double tValue;          ///< 対応のある t 検定の t 値
+        double pValue;          ///< 両側 p 値 (正規近似)
+        int winCount;           ///< 基準より少ないターンで終えたステージ数
+        int lossCount;          ///< 基準より多いターンを要したステージ数
+        int tieCount;           ///< 基準と同じターン数のステージ数
+    };
+
+    Tournament();
+    void reset(const std::vector<const AnswerEntry*>& aEntries, int aStageCount); ///< 解答とステージ数を設定し、結果を消去します。
+    int variantCount()const;                                ///< 解答の数を取得します。
+    int stageCount()const;                                  ///< ステージ数を取得します。
+    const AnswerEntry& entry(int aVariant)const;            ///< 解答を取得します。
+    void setResult(int aVariant, int aStage, int aTurn, double aSec); ///< ステージの結果を記録します。
+    int turn(int aVariant, int aStage)const;                ///< ステージのターン数を取得します。
+    int totalTurn(int aVariant)const;                       ///< 総ターン数を取得します。
+    double totalSec(int aVariant)const;                     ///< 解答に掛かった CPU 時間の合計を取得します。
+    Comparison compare(int aVariant)const;                  ///< 基準の解答と対比較します。
+    void print(bool aIsSilent)const;                        ///< 結果を出力します。
+private:
+    int index(int aVariant, int aStage)const;               ///< 結果の配列の添字を取得します。
+
+    std::vector<const AnswerEntry*> mEntries;               ///< 解答 (先頭が基準)
+    int mStageCount;                                        ///< ステージ数
+    std::vector<int> mTurns;                                ///< 解答とステージごとのターン数
+    std::vector<double> mSecs;                              ///< 解答とステージごとの CPU 時間 (秒)
+};
+
+} // namespace
+// EOF
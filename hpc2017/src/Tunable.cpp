@@ -0,0 +1,76 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "Tunable.hpp"
+
+#include <cstring>
+#include "Assert.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// インスタンスを取得します。
+TunableRegistry& TunableRegistry::Instance()
+{
+    static TunableRegistry registry;
+    return registry;
+}
+
+//------------------------------------------------------------------------------
+/// TunableRegistry クラスのインスタンスを生成します。
+TunableRegistry::TunableRegistry()
+: mEntries()
+{
+}
+
+//------------------------------------------------------------------------------
+/// 定数を登録します。
+///
+/// @param[in] aEntry 登録する定数。名前は他の定数と重ならない、'=' と ',' を含まないものにしてください。
+/// @return 常に true を返します。(静的初期化で登録するための戻り値です)
+bool TunableRegistry::add(const TunableEntry& aEntry)
+{
+    HPC_ASSERT(aEntry.name != nullptr && std::strpbrk(aEntry.name, "=,") == nullptr);
+    HPC_ASSERT(find(aEntry.name) < 0);
+    HPC_ASSERT(aEntry.minValue <= aEntry.defaultValue && aEntry.defaultValue <= aEntry.maxValue);
+    HPC_ASSERT(aEntry.apply != nullptr);
+    mEntries.push_back(aEntry);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// 名前から定数の番号を探します。
+int TunableRegistry::find(const char* aName)const
+{
+    for (int i = 0; i < count(); ++i) {
+        if (!std::strcmp(mEntries[i].name, aName)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+/// 登録された定数の数を取得します。
+int TunableRegistry::count()const
+{
+    return int(mEntries.size());
+}
+
+//------------------------------------------------------------------------------
+/// 登録された定数を取得します。
+const TunableEntry& TunableRegistry::entry(int aIndex)const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(aIndex, 0, count());
+    return mEntries[aIndex];
+}
+
+} // namespace
+// EOF
@@ -0,0 +1,62 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <vector>
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// 調整できる解答の定数。
+///
+/// 値は解答が thread_local に持つので、apply は呼び出したスレッドの値だけを書き換えます。
+struct TunableEntry
+{
+    const char* name;               ///< 登録名
+    double defaultValue;            ///< 提出する解答で使う値
+    double minValue;                ///< 探索する範囲の最小値
+    double maxValue;                ///< 探索する範囲の最大値
+    bool isInteger;                 ///< 整数の定数か
+    void (*apply)(double aValue);   ///< 呼び出したスレッドの値を書き換える関数
+};
+
+//------------------------------------------------------------------------------
+/// 調整できる定数の登録簿。
+///
+/// HPC_REGISTER_TUNABLE で、静的初期化の時に登録します。-tune で使います。
+class TunableRegistry
+{
+public:
+    static TunableRegistry& Instance();                     ///< インスタンスを取得します。
+
+    bool add(const TunableEntry& aEntry);                   ///< 定数を登録します。
+    int find(const char* aName)const;                       ///< 名前から定数の番号を探します。見つからなければ -1。
+    int count()const;                                       ///< 登録された定数の数を取得します。
+    const TunableEntry& entry(int aIndex)const;             ///< 登録された定数を取得します。
+
+private:
+    TunableRegistry();
+
+    std::vector<TunableEntry> mEntries;                     ///< 登録された順の定数
+};
+
+} // namespace
+
+#define HPC_REGISTER_TUNABLE_NAME_HELPER(aCounter) sTunableRegistered ## aCounter
+#define HPC_REGISTER_TUNABLE_NAME(aCounter) HPC_REGISTER_TUNABLE_NAME_HELPER(aCounter)
+
+/// 定数を aName の名前で登録します。名前空間のスコープに書いてください。
+/// aApply は、値を受け取って呼び出したスレッドの定数を書き換える関数です。(キャプチャのないラムダ式も使えます)
+#define HPC_REGISTER_TUNABLE(aName, aDefault, aMin, aMax, aIsInteger, aApply) \
+    static const bool HPC_REGISTER_TUNABLE_NAME(__COUNTER__) = \
+        ::hpc::TunableRegistry::Instance().add(::hpc::TunableEntry{ aName, double(aDefault), double(aMin), double(aMax), aIsInteger, aApply })
+
+// EOF
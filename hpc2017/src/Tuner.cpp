@@ -0,0 +1,340 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#include "Tuner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Assert.hpp"
+#include "Print.hpp"
+#include "Tunable.hpp"
+
+namespace hpc {
+
+namespace {
+
+//------------------------------------------------------------------------------
+/// 定数の値を文字列にします。
+std::string FormatValue(const TunableEntry& aEntry, double aValue)
+{
+    char buffer[32];
+    if (aEntry.isInteger) {
+        std::snprintf(buffer, sizeof(buffer), "%d", int(aValue));
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.3g", aValue);
+    }
+    return buffer;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/// Tuner クラスのインスタンスを生成します。
+Tuner::Tuner()
+: mConfigs()
+, mSweepCount(0)
+, mStageCount(0)
+, mRoundCount(0)
+, mRound(-1)
+, mSurvivors()
+, mStageDone()
+, mTurns()
+, mSecs()
+{
+}
+
+//------------------------------------------------------------------------------
+/// 既定値の設定を加えます。
+void Tuner::addDefault()
+{
+    const TunableRegistry& registry = TunableRegistry::Instance();
+    Config config;
+    config.label = "default";
+    for (int p = 0; p < registry.count(); ++p) {
+        config.values.push_back(registry.entry(p).defaultValue);
+    }
+    mConfigs.push_back(config);
+}
+
+//------------------------------------------------------------------------------
+/// 範囲から一様に選んだ設定を加えます。
+///
+/// @param[in] aCount 加える設定の数。
+/// @param[in,out] aRandom 値を選ぶ乱数生成器。
+void Tuner::addRandom(int aCount, Random& aRandom)
+{
+    const TunableRegistry& registry = TunableRegistry::Instance();
+    for (int i = 0; i < aCount; ++i) {
+        Config config;
+        char label[32];
+        std::snprintf(label, sizeof(label), "random%d", i);
+        config.label = label;
+        for (int p = 0; p < registry.count(); ++p) {
+            const TunableEntry& entry = registry.entry(p);
+            if (entry.isInteger) {
+                config.values.push_back(aRandom.randMinMax(int(entry.minValue), int(entry.maxValue)));
+            } else {
+                config.values.push_back(entry.minValue + aRandom.randFloat() * (entry.maxValue - entry.minValue));
+            }
+        }
+        mConfigs.push_back(config);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// 1つの定数だけを既定値から変えた設定を加えます。
+///
+/// 登録された範囲の外の値も使えます。
+///
+/// @param[in] aSpec "名前=値1,値2,..." の形の文字列。値ごとに1つの設定を加えます。
+/// @return 名前が登録されていないか、値が読めなければ false を返します。
+bool Tuner::addSweep(const char* aSpec)
+{
+    const TunableRegistry& registry = TunableRegistry::Instance();
+    const char* equal = std::strchr(aSpec, '=');
+    if (equal == nullptr) {
+        return false;
+    }
+    const int param = registry.find(std::string(aSpec, equal).c_str());
+    if (param < 0) {
+        return false;
+    }
+    const TunableEntry& entry = registry.entry(param);
+
+    std::vector<double> values;
+    const char* text = equal + 1;
+    for (;;) {
+        char* end = nullptr;
+        const double value = std::strtod(text, &end);
+        if (end == text || (*end != ',' && *end != '\0')) {
+            return false;
+        }
+        values.push_back(entry.isInteger ? std::round(value) : value);
+        if (*end == '\0') {
+            break;
+        }
+        text = end + 1;
+    }
+
+    for (double value : values) {
+        Config config;
+        char label[32];
+        std::snprintf(label, sizeof(label), "sweep%d", mSweepCount++);
+        config.label = label;
+        for (int p = 0; p < registry.count(); ++p) {
+            config.values.push_back(p == param ? value : registry.entry(p).defaultValue);
+        }
+        mConfigs.push_back(config);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// 設定の数を取得します。
+int Tuner::configCount()const
+{
+    return int(mConfigs.size());
+}
+
+//------------------------------------------------------------------------------
+/// 呼び出したスレッドの定数を設定の値にします。
+///
+/// 定数は解答が thread_local に持つので、ステージを実行するワーカーで呼び出してください。
+void Tuner::apply(int aConfig)const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(aConfig, 0, configCount());
+    const TunableRegistry& registry = TunableRegistry::Instance();
+    for (int p = 0; p < registry.count(); ++p) {
+        registry.entry(p).apply(mConfigs[aConfig].values[p]);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// ステージ数を設定し、結果を消去します。
+///
+/// 設定が n 個なら、半分ずつ減らして1つになるまで ceil(log2 n) + 1 回実行します。
+void Tuner::start(int aStageCount)
+{
+    HPC_LB_ASSERT_I(aStageCount, 1);
+    mStageCount = aStageCount;
+    mRoundCount = 1;
+    while ((1 << (mRoundCount - 1)) < configCount()) {
+        ++mRoundCount;
+    }
+    mRound = -1;
+    mSurvivors.clear();
+    for (int c = 0; c < configCount(); ++c) {
+        mSurvivors.push_back(c);
+    }
+    mStageDone.assign(configCount(), 0);
+    mTurns.assign(configCount() * aStageCount, 0);
+    mSecs.assign(configCount() * aStageCount, 0.0);
+}
+
+//------------------------------------------------------------------------------
+/// 次の回に進めます。
+///
+/// 前の回があれば、その回までのステージあたりのターン数 (同じなら CPU 時間) で良い半分を残します。
+///
+/// @return 全ての回を終えていれば false を返します。
+bool Tuner::nextRound()
+{
+    if (mRound >= 0) {
+        for (int c : mSurvivors) {
+            mStageDone[c] = roundEnd();
+        }
+        if (mRound + 1 >= mRoundCount) {
+            return false;
+        }
+        std::stable_sort(mSurvivors.begin(), mSurvivors.end(), [&](int aLhs, int aRhs) {
+            if (meanTurn(aLhs) != meanTurn(aRhs)) {
+                return meanTurn(aLhs) < meanTurn(aRhs);
+            }
+            return meanSec(aLhs) < meanSec(aRhs);
+        });
+        mSurvivors.resize((mSurvivors.size() + 1) / 2);
+        std::sort(mSurvivors.begin(), mSurvivors.end());
+    }
+    ++mRound;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// この回で実行する設定を取得します。
+const std::vector<int>& Tuner::survivors()const
+{
+    return mSurvivors;
+}
+
+//------------------------------------------------------------------------------
+/// この回で実行する最初のステージを取得します。
+int Tuner::roundBegin()const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(mRound, 0, mRoundCount);
+    return mRound == 0 ? 0 : std::max(1, mStageCount >> (mRoundCount - mRound));
+}
+
+//------------------------------------------------------------------------------
+/// この回で実行するステージの終わり (含まない) を取得します。
+///
+/// 最後の回で全てのステージになるよう、1回ごとに倍にします。
+int Tuner::roundEnd()const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(mRound, 0, mRoundCount);
+    return std::max(1, mStageCount >> (mRoundCount - 1 - mRound));
+}
+
+//------------------------------------------------------------------------------
+/// ステージの結果を記録します。
+///
+/// @param[in] aConfig 設定の番号。
+/// @param[in] aStage ステージの番号。
+/// @param[in] aTurn ステージに掛かったターン数。
+/// @param[in] aSec 解答に掛かった CPU 時間 (秒)。
+void Tuner::setResult(int aConfig, int aStage, int aTurn, double aSec)
+{
+    mTurns[index(aConfig, aStage)] = aTurn;
+    mSecs[index(aConfig, aStage)] = aSec;
+}
+
+//------------------------------------------------------------------------------
+/// 結果を順位の表で出力します。
+///
+/// 多くのステージを実行した設定ほど上に、同じステージ数ならターン数の少ない順に並べます。
+/// 同じステージ数の中で、ターン数と時間の両方で勝る設定がないもの (パレート最適) に P の列で '*' を付けます。
+/// 設定の値は、既定値と違うものだけを出力します。
+void Tuner::print(bool aIsSilent)const
+{
+    std::vector<int> order;
+    for (int c = 0; c < configCount(); ++c) {
+        order.push_back(c);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int aLhs, int aRhs) {
+        if (mStageDone[aLhs] != mStageDone[aRhs]) {
+            return mStageDone[aLhs] > mStageDone[aRhs];
+        }
+        if (meanTurn(aLhs) != meanTurn(aRhs)) {
+            return meanTurn(aLhs) < meanTurn(aRhs);
+        }
+        return meanSec(aLhs) < meanSec(aRhs);
+    });
+
+    const TunableRegistry& registry = TunableRegistry::Instance();
+    const int rowCount = aIsSilent ? std::min(1, configCount()) : configCount();
+    HPC_PRINTF("rank | stages | turn/stage | sec/stage | P | config\n");
+    for (int r = 0; r < rowCount; ++r) {
+        const int c = order[r];
+        bool isDominated = false;
+        for (int other = 0; other < configCount(); ++other) {
+            if (mStageDone[other] == mStageDone[c]
+                && meanTurn(other) <= meanTurn(c) && meanSec(other) <= meanSec(c)
+                && (meanTurn(other) < meanTurn(c) || meanSec(other) < meanSec(c))) {
+                isDominated = true;
+                break;
+            }
+        }
+        std::string values;
+        for (int p = 0; p < registry.count(); ++p) {
+            const TunableEntry& entry = registry.entry(p);
+            if (mConfigs[c].values[p] != entry.defaultValue) {
+                values += " " + std::string(entry.name) + "=" + FormatValue(entry, mConfigs[c].values[p]);
+            }
+        }
+        HPC_PRINTF("% 4d | % 6d | % 10.3f | % 9.4f | %c | %s%s\n",
+            r + 1, mStageDone[c], meanTurn(c), meanSec(c), isDominated ? ' ' : '*',
+            mConfigs[c].label.c_str(), values.c_str());
+    }
+    HPC_PRINTF("Configs: %d Stages: %d Rounds: %d\n", configCount(), mStageCount, mRoundCount);
+}
+
+//------------------------------------------------------------------------------
+/// 結果の配列の添字を取得します。
+int Tuner::index(int aConfig, int aStage)const
+{
+    HPC_RANGE_ASSERT_MIN_UB_I(aConfig, 0, configCount());
+    HPC_RANGE_ASSERT_MIN_UB_I(aStage, 0, mStageCount);
+    return aConfig * mStageCount + aStage;
+}
+
+//------------------------------------------------------------------------------
+/// 実行したステージあたりのターン数を取得します。
+double Tuner::meanTurn(int aConfig)const
+{
+    const int stageCount = mStageDone[aConfig];
+    if (stageCount == 0) {
+        return 0.0;
+    }
+    double total = 0.0;
+    for (int i = 0; i < stageCount; ++i) {
+        total += mTurns[index(aConfig, i)];
+    }
+    return total / stageCount;
+}
+
+//------------------------------------------------------------------------------
+/// 実行したステージあたりの CPU 時間を取得します。
+double Tuner::meanSec(int aConfig)const
+{
+    const int stageCount = mStageDone[aConfig];
+    if (stageCount == 0) {
+        return 0.0;
+    }
+    double total = 0.0;
+    for (int i = 0; i < stageCount; ++i) {
+        total += mSecs[index(aConfig, i)];
+    }
+    return total / stageCount;
+}
+
+} // namespace
+// EOF
@@ -0,0 +1,66 @@
+﻿//------------------------------------------------------------------------------
+/// @file
+/// @author   ハル研究所プログラミングコンテスト実行委員会
+///
+/// @copyright  Copyright (c) 2017 HAL Laboratory, Inc.
+/// @attention  このファイルの利用は、同梱のREADMEにある
+///             利用条件に従ってください。
+//------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Random.hpp"
+
+namespace hpc {
+
+//------------------------------------------------------------------------------
+/// 登録された定数の組 (設定) を同じステージで比べる、successive halving による調整。
+///
+/// 1回目は全ての設定を少ないステージで実行し、ステージあたりのターン数の良い半分だけを残します。
+/// 回を重ねるごとにステージ数を倍にし、最後に残った設定は全てのステージで実行します。
+/// 各回のステージは前の回の続きなので、残った設定は同じステージで比べられます。
+/// 結果は設定とステージの組ごとに別の要素に書くので、
+/// 違う組であればワーカースレッドから同時に setResult() を呼び出せます。
+class Tuner
+{
+public:
+    Tuner();
+    void addDefault();                                      ///< 既定値の設定を加えます。
+    void addRandom(int aCount, Random& aRandom);            ///< 範囲から一様に選んだ設定を加えます。
+    bool addSweep(const char* aSpec);                       ///< 1つの定数だけを既定値から変えた設定を加えます。
+    int configCount()const;                                 ///< 設定の数を取得します。
+    void apply(int aConfig)const;                           ///< 呼び出したスレッドの定数を設定の値にします。
+    void start(int aStageCount);                            ///< ステージ数を設定し、結果を消去します。
+    bool nextRound();                                       ///< 次の回に進めます。全ての回を終えていれば false。
+    const std::vector<int>& survivors()const;               ///< この回で実行する設定を取得します。
+    int roundBegin()const;                                  ///< この回で実行する最初のステージを取得します。
+    int roundEnd()const;                                    ///< この回で実行するステージの終わり (含まない) を取得します。
+    void setResult(int aConfig, int aStage, int aTurn, double aSec); ///< ステージの結果を記録します。
+    void print(bool aIsSilent)const;                        ///< 結果を順位の表で出力します。
+private:
+    struct Config
+    {
+        std::string label;                                  ///< 表に出す名前
+        std::vector<double> values;                         ///< 定数ごとの値 (登録の順)
+    };
+
+    int index(int aConfig, int aStage)const;                ///< 結果の配列の添字を取得します。
+    double meanTurn(int aConfig)const;                      ///< 実行したステージあたりのターン数を取得します。
+    double meanSec(int aConfig)const;                       ///< 実行したステージあたりの CPU 時間を取得します。
+
+    std::vector<Config> mConfigs;                           ///< 設定 (先頭が既定値)
+    int mSweepCount;                                        ///< addSweep() で加えた設定の数
+    int mStageCount;                                        ///< ステージ数
+    int mRoundCount;                                        ///< 回の数
+    int mRound;                                             ///< 今の回 (開始前は -1)
+    std::vector<int> mSurvivors;                            ///< この回で実行する設定
+    std::vector<int> mStageDone;                            ///< 設定ごとの実行したステージ数
+    std::vector<int> mTurns;                                ///< 設定とステージごとのターン数
+    std::vector<double> mSecs;                              ///< 設定とステージごとの CPU 時間 (秒)
+};
+
+} // namespace
+// EOF